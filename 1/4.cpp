@@ -2,7 +2,27 @@
 #include <fstream>
 #include <string>
 #include <stdexcept>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <vector>
+#include <string_view>
+#include <cstring>
+#include <cerrno>
+#include <cstdint>
+#include <algorithm>
+#include <thread>
 
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+
+class ChunkReader;
 
 class FileHandler {
 protected:
@@ -33,6 +53,15 @@ public:
     }
 
     
+    virtual size_t readSome(char*, size_t) {
+       throw std::logic_error("Функция readSome не поддерживается для данного типа файла.");
+    }
+
+    // Чтение с текущей позиции до конца блоками по chunkSize байт через readSome():
+    // for (std::string_view chunk : handler.chunks(4096)) { ... }
+    ChunkReader chunks(size_t chunkSize);
+
+    
     virtual ~FileHandler() {
         if (file.is_open()) {
             file.close();
@@ -51,32 +80,165 @@ public:
 
 
 class TextFileHandler : public FileHandler {
+private:
+    static constexpr size_t kBlockSize = 64 * 1024;
+
+    // Буфер блочного чтения: [begin, end) — ещё не выданные данные.
+    std::vector<char> buffer;
+    size_t begin = 0;
+    size_t end = 0;
+
+    // Дочитывает следующий блок за уже прочитанными данными; false — конец файла.
+    bool fillBuffer() {
+        if (begin > 0) {
+            std::memmove(buffer.data(), buffer.data() + begin, end - begin);
+            end -= begin;
+            begin = 0;
+        }
+        if (buffer.size() - end < kBlockSize) {
+            buffer.resize(end + kBlockSize);
+        }
+        file.read(buffer.data() + end, static_cast<std::streamsize>(buffer.size() - end));
+        if (file.bad()) {
+            throw std::runtime_error("Ошибка чтения файла: " + filename);
+        }
+        const size_t got = static_cast<size_t>(file.gcount());
+        end += got;
+        return got > 0;
+    }
+
 public:
     
     TextFileHandler(const std::string& filename) : FileHandler(filename) {}
 
+    // Следующая строка без символа перевода строки. Файл читается блоками по 64 КБ,
+    // конец строки ищется memchr; line указывает во внутренний буфер и действительна
+    // до следующего чтения. Возвращает false, когда строки закончились.
+    bool readLineView(std::string_view& line) {
+        if (!file.is_open()) {
+            throw std::runtime_error("Файл не открыт: " + filename);
+        }
+        size_t scanned = begin;
+        while (true) {
+            const char* newline = end > scanned
+                ? static_cast<const char*>(std::memchr(buffer.data() + scanned, '\n', end - scanned))
+                : nullptr;
+            if (newline != nullptr) {
+                const size_t lineEnd = static_cast<size_t>(newline - buffer.data());
+                line = std::string_view(buffer.data() + begin, lineEnd - begin);
+                begin = lineEnd + 1;
+                return true;
+            }
+            scanned = end - begin;
+            if (!fillBuffer()) {
+                if (begin == end) {
+                    return false;
+                }
+                line = std::string_view(buffer.data() + begin, end - begin);
+                begin = end;
+                return true;
+            }
+        }
+    }
+
     
     std::string readLine() override {
-        std::string line;
-        if (file.is_open()) {
-            if (std::getline(file, line)) {
-                return line;
-            } else {
-                return ""; 
-            }
-        } else {
-            throw std::runtime_error("Файл не открыт: " + filename);
+        std::string_view line;
+        if (readLineView(line)) {
+            return std::string(line);
         }
+        return "";
     }
 };
 
 
 class BinaryFileHandler : public FileHandler {
+private:
+    // Отдельный системный дескриптор для позиционного чтения: у него нет общей
+    // позиции, поэтому readBytesAt() можно вызывать из нескольких потоков.
+#if defined(_WIN32)
+    HANDLE handle = INVALID_HANDLE_VALUE;
+#else
+    int descriptor = -1;
+#endif
+
 public:
     
     BinaryFileHandler(const std::string& filename) : FileHandler(filename) {}
 
     
+    void open() override {
+        FileHandler::open();
+#if defined(_WIN32)
+        handle = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+            FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr);
+        if (handle == INVALID_HANDLE_VALUE) {
+            throw std::runtime_error("Файл не найден: " + filename);
+        }
+#else
+        descriptor = ::open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+        if (descriptor < 0) {
+            throw std::runtime_error("Файл не найден: " + filename);
+        }
+#endif
+    }
+
+    
+    ~BinaryFileHandler() override {
+#if defined(_WIN32)
+        if (handle != INVALID_HANDLE_VALUE) {
+            CloseHandle(handle);
+        }
+#else
+        if (descriptor >= 0) {
+            ::close(descriptor);
+        }
+#endif
+    }
+
+    // Позиционное чтение до size байт со смещения offset (pread): позиция потока
+    // file не меняется, вызовы из разных потоков не мешают друг другу. У конца файла
+    // возвращает меньше size байт, за концом — 0.
+    size_t readBytesAt(uint64_t offset, char* buffer, size_t size) const {
+        size_t total = 0;
+        while (total < size) {
+#if defined(_WIN32)
+            if (handle == INVALID_HANDLE_VALUE) {
+                throw std::runtime_error("Файл не открыт: " + filename);
+            }
+            OVERLAPPED position = {};
+            const uint64_t at = offset + total;
+            position.Offset = static_cast<DWORD>(at);
+            position.OffsetHigh = static_cast<DWORD>(at >> 32);
+            const DWORD request = static_cast<DWORD>(std::min<size_t>(size - total, 1u << 30));
+            DWORD got = 0;
+            if (!ReadFile(handle, buffer + total, request, &got, &position)) {
+                if (GetLastError() == ERROR_HANDLE_EOF) {
+                    break;
+                }
+                throw std::runtime_error("Ошибка чтения файла: " + filename);
+            }
+#else
+            if (descriptor < 0) {
+                throw std::runtime_error("Файл не открыт: " + filename);
+            }
+            const ssize_t got = ::pread(descriptor, buffer + total, size - total, static_cast<off_t>(offset + total));
+            if (got < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw std::runtime_error("Ошибка чтения файла: " + filename);
+            }
+#endif
+            if (got == 0) {
+                break;
+            }
+            total += static_cast<size_t>(got);
+        }
+        return total;
+    }
+
+    
     void readBytes(char* buffer, size_t size) override {
         if (file.is_open()) {
             file.read(buffer, size);
@@ -87,8 +249,169 @@ public:
             throw std::runtime_error("Файл не открыт: " + filename);
         }
     }
+
+    // Короткое чтение: до size байт, у конца файла меньше, после конца — 0.
+    size_t readSome(char* buffer, size_t size) override {
+        if (!file.is_open()) {
+            throw std::runtime_error("Файл не открыт: " + filename);
+        }
+        file.read(buffer, size);
+        if (file.bad()) {
+            throw std::runtime_error("Ошибка чтения файла: " + filename);
+        }
+        return static_cast<size_t>(file.gcount());
+    }
 };
 
+
+// Последовательное чтение через readSome() блоками фиксированного размера с упреждением:
+// пока вызывающий обрабатывает текущий блок, следующий читается в фоне одним потоком
+// чтения на объект, блоки передаются через условную переменную. Память ограничена
+// двумя блоками, последний блок может быть короче, после него next() возвращает пустой
+// view. Пока жив ChunkReader, читать из того же FileHandler напрямую нельзя.
+class ChunkReader {
+public:
+    ChunkReader(FileHandler& handler, size_t chunkSize)
+        : source(handler), current(chunkSize), ahead(chunkSize) {
+        if (chunkSize == 0) {
+            throw std::invalid_argument("Размер блока должен быть больше нуля.");
+        }
+        worker = std::thread([this]() { readLoop(); });
+    }
+
+    ChunkReader(const ChunkReader&) = delete;
+    ChunkReader& operator=(const ChunkReader&) = delete;
+
+    ~ChunkReader() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        changed.notify_one();
+        worker.join();
+    }
+
+    // Следующий блок; действителен до следующего вызова next()
+    std::string_view next() {
+        if (finished) {
+            return {};
+        }
+
+        std::unique_lock<std::mutex> lock(mutex);
+        changed.wait(lock, [this]() { return aheadReady; });
+        if (readError) {
+            finished = true;
+            std::rethrow_exception(readError);
+        }
+        const size_t length = aheadLength;
+        current.swap(ahead);
+        aheadReady = false;
+        finished = length < current.size();
+        lock.unlock();
+        changed.notify_one();
+
+        chunkOffset = nextOffset;
+        nextOffset += length;
+        return std::string_view(current.data(), length);
+    }
+
+    // Смещение последнего блока, возвращённого next(), от позиции начала чтения
+    uint64_t offset() const {
+        return chunkOffset;
+    }
+
+    // Обход блоков в цикле for: for (std::string_view chunk : reader) { ... }
+    class Iterator {
+    public:
+        explicit Iterator(ChunkReader* chunkReader) : reader(chunkReader) {}
+
+        std::string_view operator*() const {
+            return chunk;
+        }
+
+        Iterator& operator++() {
+            chunk = reader->next();
+            if (chunk.empty()) {
+                reader = nullptr;
+            }
+            return *this;
+        }
+
+        bool operator!=(const Iterator& other) const {
+            return reader != other.reader;
+        }
+
+    private:
+        ChunkReader* reader;
+        std::string_view chunk;
+    };
+
+    Iterator begin() {
+        return ++Iterator(this);
+    }
+
+    Iterator end() {
+        return Iterator(nullptr);
+    }
+
+private:
+    FileHandler& source;
+    std::vector<char> current;
+    std::vector<char> ahead;
+    uint64_t chunkOffset = 0;
+    uint64_t nextOffset = 0;
+    bool finished = false;
+
+    // Состояние, общее с потоком чтения: ahead заполнен (aheadReady) или свободен
+    std::mutex mutex;
+    std::condition_variable changed;
+    bool aheadReady = false;
+    bool stopping = false;
+    size_t aheadLength = 0;
+    std::exception_ptr readError;
+    std::thread worker;
+
+    // Поток чтения живёт вместе с объектом: заполняет ahead, ждёт, пока next() его
+    // заберёт, и завершается после короткого блока, ошибки или деструктора.
+    void readLoop() {
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                changed.wait(lock, [this]() { return stopping || !aheadReady; });
+                if (stopping) {
+                    return;
+                }
+            }
+
+            size_t length = 0;
+            std::exception_ptr error;
+            try {
+                length = source.readSome(ahead.data(), ahead.size());
+            }
+            catch (...) {
+                error = std::current_exception();
+            }
+
+            // После aheadReady буфер ahead принадлежит next(), размер читается до этого
+            const bool last = error || length < ahead.size();
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                aheadLength = length;
+                readError = error;
+                aheadReady = true;
+            }
+            changed.notify_one();
+            if (last) {
+                return;
+            }
+        }
+    }
+};
+
+ChunkReader FileHandler::chunks(size_t chunkSize) {
+    return ChunkReader(*this, chunkSize);
+}
+
 int main() {
     try {
         TextFileHandler textFile("example.txt"); 
@@ -96,6 +419,11 @@ int main() {
         std::string line = textFile.readLine();
         std::cout << "Прочитанная строка: " << line << std::endl;
 
+        std::string_view lineView;
+        while (textFile.readLineView(lineView)) {
+            std::cout << "Строка из буфера: " << lineView << std::endl;
+        }
+
         BinaryFileHandler binaryFile("example.bin"); 
         binaryFile.open();
         char buffer[10];
@@ -106,6 +434,30 @@ int main() {
         }
         std::cout << std::endl;
 
+        size_t chunkCount = 0;
+        size_t bytes = 0;
+        for (std::string_view chunk : binaryFile.chunks(4)) {
+            ++chunkCount;
+            bytes += chunk.size();
+        }
+        std::cout << "Остаток файла: " << bytes << " байт в " << chunkCount << " блоках" << std::endl;
+
+        // Несколько потоков читают разные участки одного открытого файла
+        std::vector<std::vector<char>> parts(4, std::vector<char>(4));
+        std::vector<size_t> partSizes(parts.size());
+        std::vector<std::thread> readers;
+        for (size_t i = 0; i < parts.size(); ++i) {
+            readers.emplace_back([&, i]() {
+                partSizes[i] = binaryFile.readBytesAt(i * 4, parts[i].data(), parts[i].size());
+            });
+        }
+        for (auto& reader : readers) {
+            reader.join();
+        }
+        for (size_t i = 0; i < parts.size(); ++i) {
+            std::cout << "Смещение " << i * 4 << ": " << partSizes[i] << " байт" << std::endl;
+        }
+
         
         FileHandler invalidFile("nonexistent.txt");
         invalidFile.open(); 
@@ -1,8 +1,276 @@
 #include <iostream>
 #include <fstream>
 #include <string>
+#include <string_view>
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <mutex>
 #include <stdexcept>
-#include <sstream>
+#include <thread>
+#include <vector>
+
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Файл, отображённый в память только для чтения. Представление view() действительно,
+// пока жив объект FileView; дескриптор закрывается сразу после отображения.
+class FileView {
+public:
+    FileView() = default;
+
+    explicit FileView(const std::string& path) {
+#if defined(_WIN32)
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+            FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            throw std::runtime_error("Не удалось открыть файл: " + path);
+        }
+
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize)) {
+            CloseHandle(file);
+            throw std::runtime_error("Не удалось получить размер файла: " + path);
+        }
+        size = static_cast<size_t>(fileSize.QuadPart);
+
+        if (size > 0) {
+            HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (mapping != nullptr) {
+                data = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+                CloseHandle(mapping);
+            }
+        }
+        CloseHandle(file);
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("Не удалось открыть файл: " + path);
+        }
+
+        struct stat info;
+        if (::fstat(fd, &info) != 0) {
+            ::close(fd);
+            throw std::runtime_error("Не удалось получить размер файла: " + path);
+        }
+        size = static_cast<size_t>(info.st_size);
+
+        if (size > 0) {
+            void* address = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (address != MAP_FAILED) {
+                ::madvise(address, size, MADV_SEQUENTIAL);
+                data = static_cast<const char*>(address);
+            }
+        }
+        ::close(fd);
+#endif
+
+        if (size > 0 && data == nullptr) {
+            throw std::runtime_error("Не удалось отобразить файл в память: " + path);
+        }
+    }
+
+    FileView(FileView&& other) noexcept : data(other.data), size(other.size) {
+        other.data = nullptr;
+        other.size = 0;
+    }
+
+    FileView& operator=(FileView&& other) noexcept {
+        if (this != &other) {
+            release();
+            data = other.data;
+            size = other.size;
+            other.data = nullptr;
+            other.size = 0;
+        }
+        return *this;
+    }
+
+    FileView(const FileView&) = delete;
+    FileView& operator=(const FileView&) = delete;
+
+    ~FileView() {
+        release();
+    }
+
+    std::string_view view() const {
+        return std::string_view(data, size);
+    }
+
+private:
+    const char* data = nullptr;
+    size_t size = 0;
+
+    void release() {
+        if (data == nullptr) {
+            return;
+        }
+#if defined(_WIN32)
+        UnmapViewOfFile(data);
+#else
+        ::munmap(const_cast<char*>(data), size);
+#endif
+        data = nullptr;
+    }
+};
+
+// Последовательное чтение файла блоками фиксированного размера с упреждением: пока
+// вызывающий обрабатывает текущий блок, следующий читается в фоне одним потоком
+// чтения на объект, блоки передаются через условную переменную. Память ограничена
+// двумя блоками независимо от размера файла. Последний блок может быть короче
+// (короткое чтение у конца файла), после него next() возвращает пустой view.
+class ChunkReader {
+public:
+    static constexpr size_t kDefaultChunkSize = 1024 * 1024;
+
+    explicit ChunkReader(const std::string& path, size_t chunkSize = kDefaultChunkSize)
+        : file(path, std::ios::binary), current(std::max<size_t>(chunkSize, 1)), ahead(current.size()) {
+        if (!file.is_open()) {
+            throw std::runtime_error("Не удалось открыть файл: " + path);
+        }
+        worker = std::thread([this]() { readLoop(); });
+    }
+
+    ChunkReader(const ChunkReader&) = delete;
+    ChunkReader& operator=(const ChunkReader&) = delete;
+
+    ~ChunkReader() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        changed.notify_one();
+        worker.join();
+    }
+
+    // Следующий блок; действителен до следующего вызова next()
+    std::string_view next() {
+        if (finished) {
+            return {};
+        }
+
+        std::unique_lock<std::mutex> lock(mutex);
+        changed.wait(lock, [this]() { return aheadReady; });
+        if (readError) {
+            finished = true;
+            std::rethrow_exception(readError);
+        }
+        const size_t length = aheadLength;
+        current.swap(ahead);
+        aheadReady = false;
+        finished = length < current.size();
+        lock.unlock();
+        changed.notify_one();
+
+        chunkOffset = nextOffset;
+        nextOffset += length;
+        return std::string_view(current.data(), length);
+    }
+
+    // Смещение в файле последнего блока, возвращённого next()
+    uint64_t offset() const {
+        return chunkOffset;
+    }
+
+    // Обход блоков в цикле for: for (std::string_view chunk : reader) { ... }
+    class Iterator {
+    public:
+        explicit Iterator(ChunkReader* chunkReader) : reader(chunkReader) {}
+
+        std::string_view operator*() const {
+            return chunk;
+        }
+
+        Iterator& operator++() {
+            chunk = reader->next();
+            if (chunk.empty()) {
+                reader = nullptr;
+            }
+            return *this;
+        }
+
+        bool operator!=(const Iterator& other) const {
+            return reader != other.reader;
+        }
+
+    private:
+        ChunkReader* reader;
+        std::string_view chunk;
+    };
+
+    Iterator begin() {
+        return ++Iterator(this);
+    }
+
+    Iterator end() {
+        return Iterator(nullptr);
+    }
+
+private:
+    std::ifstream file;
+    std::vector<char> current;
+    std::vector<char> ahead;
+    uint64_t chunkOffset = 0;
+    uint64_t nextOffset = 0;
+    bool finished = false;
+
+    // Состояние, общее с потоком чтения: ahead заполнен (aheadReady) или свободен
+    std::mutex mutex;
+    std::condition_variable changed;
+    bool aheadReady = false;
+    bool stopping = false;
+    size_t aheadLength = 0;
+    std::exception_ptr readError;
+    std::thread worker;
+
+    // Поток чтения живёт вместе с объектом: заполняет ahead, ждёт, пока next() его
+    // заберёт, и завершается после короткого блока, ошибки или деструктора.
+    void readLoop() {
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                changed.wait(lock, [this]() { return stopping || !aheadReady; });
+                if (stopping) {
+                    return;
+                }
+            }
+
+            size_t length = 0;
+            std::exception_ptr error;
+            try {
+                file.read(ahead.data(), static_cast<std::streamsize>(ahead.size()));
+                if (file.bad()) {
+                    throw std::runtime_error("Ошибка чтения блока файла");
+                }
+                length = static_cast<size_t>(file.gcount());
+            }
+            catch (...) {
+                error = std::current_exception();
+            }
+
+            // После aheadReady буфер ahead принадлежит next(), размер читается до этого
+            const bool last = error || length < ahead.size();
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                aheadLength = length;
+                readError = error;
+                aheadReady = true;
+            }
+            changed.notify_one();
+            if (last) {
+                return;
+            }
+        }
+    }
+};
 
 // Базовый класс FileReader
 class FileReader {
@@ -28,6 +296,45 @@ public:
     std::string getFilePath() const {
         return filePath;
     }
+
+    // Размер файла в байтах — сколько места нужно буферу для readInto()
+    size_t getFileSize() const {
+        std::ifstream file(filePath, std::ios::binary | std::ios::ate);
+        if (!file.is_open()) {
+            throw std::runtime_error("Не удалось открыть файл: " + filePath);
+        }
+        return static_cast<size_t>(file.tellg());
+    }
+
+    // Чтение сырых байт файла в буфер вызывающего без промежуточных копий.
+    // Возвращает число прочитанных байт; буфер меньше файла — исключение.
+    size_t readInto(char* buffer, size_t capacity) const {
+        std::ifstream file(filePath, std::ios::binary | std::ios::ate);
+        if (!file.is_open()) {
+            throw std::runtime_error("Не удалось открыть файл: " + filePath);
+        }
+        const size_t size = static_cast<size_t>(file.tellg());
+        if (size > capacity) {
+            throw std::runtime_error("Буфер меньше файла: " + filePath);
+        }
+        file.seekg(0, std::ios::beg);
+        file.read(buffer, static_cast<std::streamsize>(size));
+        if (static_cast<size_t>(file.gcount()) != size) {
+            throw std::runtime_error("Ошибка чтения файла: " + filePath);
+        }
+        return size;
+    }
+
+    // Сырые байты файла, отображённые в память: данные действительны, пока жив FileView.
+    FileView map() const {
+        return FileView(filePath);
+    }
+
+    // Сырые байты файла блоками по chunkSize байт с упреждающим чтением;
+    // файлы больше оперативной памяти читаются с постоянным расходом памяти.
+    ChunkReader chunks(size_t chunkSize = ChunkReader::kDefaultChunkSize) const {
+        return ChunkReader(filePath, chunkSize);
+    }
 };
 
 // Производный класс TextFileReader
@@ -43,9 +350,14 @@ public:
             throw std::runtime_error("Не удалось открыть файл: " + filePath);
         }
 
-        std::stringstream buffer;
-        buffer << file.rdbuf();
-        return buffer.str();
+        // Чтение сразу в строку; размер на диске — верхняя граница, так как
+        // в текстовом режиме \r\n может сократиться до \n.
+        file.seekg(0, std::ios::end);
+        std::string content(static_cast<size_t>(file.tellg()), '\0');
+        file.seekg(0, std::ios::beg);
+        file.read(&content[0], static_cast<std::streamsize>(content.size()));
+        content.resize(static_cast<size_t>(file.gcount()));
+        return content;
     }
 };
 
@@ -57,14 +369,16 @@ public:
 
     // Переопределение функции read()
     std::string read() const override {
-        std::ifstream file(filePath, std::ios::binary);
+        std::ifstream file(filePath, std::ios::binary | std::ios::ate);
         if (!file.is_open()) {
             throw std::runtime_error("Не удалось открыть бинарный файл: " + filePath);
         }
 
-        std::stringstream buffer;
-        buffer << file.rdbuf();
-        return buffer.str();
+        // Одна копия: размер известен заранее, данные читаются сразу в строку.
+        std::string content(static_cast<size_t>(file.tellg()), '\0');
+        file.seekg(0, std::ios::beg);
+        file.read(&content[0], static_cast<std::streamsize>(content.size()));
+        return content;
     }
 };
 
@@ -85,6 +399,19 @@ int main() {
         BinaryFileReader binaryReader("example.bin");
         std::cout << "Содержимое бинарного файла: " << binaryReader.read() << std::endl;
 
+        // Чтение в буфер вызывающего и отображение в память без копий
+        std::vector<char> buffer(binaryReader.getFileSize());
+        size_t bytes = binaryReader.readInto(buffer.data(), buffer.size());
+        std::cout << "Прочитано в буфер: " << bytes << " байт" << std::endl;
+
+        FileView mapped = textReader.map();
+        std::cout << "Отображено в память: " << mapped.view() << std::endl;
+
+        // Чтение блоками по 8 байт, последний блок короче
+        for (std::string_view chunk : textReader.chunks(8)) {
+            std::cout << "Блок (" << chunk.size() << " байт): " << chunk << std::endl;
+        }
+
         // Попытка прочитать несуществующий файл
         TextFileReader invalidReader("nonexistent_file.txt");
         invalidReader.read(); // Выбросит исключение
@@ -1,7 +1,18 @@
 #include <iostream>
+#include <fstream>
 #include <string>
 #include <stdexcept>
 #include <sstream>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <new>
+#include <vector>
+
+#if defined(WITH_BENCHMARKS)
+#include "../bench/bench_harness.h"
+#endif
 
 // Базовый класс DataProcessor
 class DataProcessor {
@@ -62,7 +73,90 @@ public:
     }
 };
 
-int main() {
+#if defined(WITH_BENCHMARKS)
+// Корпуса и прогоны режима --bench; общая обвязка — bench/bench_harness.h
+struct Corpus {
+    std::vector<std::string> records;
+    size_t bytes = 0;
+};
+
+template <typename MakeRecord>
+Corpus makeCorpus(size_t targetBytes, MakeRecord&& makeRecord) {
+    Corpus corpus;
+    while (corpus.bytes < targetBytes) {
+        corpus.records.push_back(makeRecord(corpus.records.size()));
+        corpus.bytes += corpus.records.back().size();
+    }
+    return corpus;
+}
+
+std::string makeCsvRow(size_t columns, size_t n) {
+    std::string row;
+    for (size_t i = 0; i < columns; ++i) {
+        if (i) {
+            row.push_back(',');
+        }
+        switch (i % 4) {
+        case 0: row += std::to_string(n); break;
+        case 1: row += "user" + std::to_string(n); break;
+        case 2: row += "user" + std::to_string(n) + "@example.com"; break;
+        default: row += "42.5"; break;
+        }
+    }
+    return row;
+}
+
+std::string makeFlatJson(size_t n) {
+    const std::string id = std::to_string(n);
+    return R"({"id": )" + id + R"(, "name": "user)" + id + R"(", "age": )" + std::to_string(20 + n % 50) +
+        R"(, "email": "user)" + id + R"(@example.com", "active": true})";
+}
+
+std::string makeNestedJson(size_t n) {
+    const std::string id = std::to_string(n);
+    return R"({"user": {"id": )" + id + R"(, "profile": {"name": "user)" + id +
+        R"(", "address": {"city": "Moscow", "zip": "101000"}}}, "tags": ["admin", "dev"], "score": 42.5})";
+}
+
+// processData() для каждой записи корпуса
+void benchmarkProcessor(const std::string& name, const DataProcessor& processor, size_t corpusSize, const Corpus& corpus) {
+    runBenchmark(name + " processData", corpusSize, corpus.bytes, corpus.records.size(), [&]() {
+        for (const std::string& record : corpus.records) {
+            processor.processData(record);
+        }
+    });
+}
+
+void runBenchmarks(size_t limit) {
+    CSVProcessor csvProcessor;
+    JSONProcessor jsonProcessor;
+
+    for (size_t corpusSize : kCorpusSizes) {
+        if (corpusSize > limit) {
+            break;
+        }
+
+        benchmarkProcessor("CSV narrow", csvProcessor, corpusSize,
+            makeCorpus(corpusSize, [](size_t n) { return makeCsvRow(kNarrowColumns, n); }));
+        benchmarkProcessor("CSV wide", csvProcessor, corpusSize,
+            makeCorpus(corpusSize, [](size_t n) { return makeCsvRow(kWideColumns, n); }));
+        benchmarkProcessor("JSON flat", jsonProcessor, corpusSize, makeCorpus(corpusSize, makeFlatJson));
+        benchmarkProcessor("JSON nested", jsonProcessor, corpusSize, makeCorpus(corpusSize, makeNestedJson));
+    }
+}
+#endif
+
+int main(int argc, char* argv[]) {
+#if defined(WITH_BENCHMARKS)
+    if (argc > 1 && std::string(argv[1]) == "--bench") {
+        runBenchmarks(argc > 2 ? std::stoull(argv[2]) << 20 : kDefaultBenchLimit);
+        return 0;
+    }
+#else
+    (void)argc;
+    (void)argv;
+#endif
+
     try {
         CSVProcessor csvProcessor(';');
         std::cout << csvProcessor.processData("значение1;значение2;значение3") << std::endl;
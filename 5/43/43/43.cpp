@@ -3,108 +3,3539 @@
 #include <string>
 #include <vector>
 #include <stdexcept>
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cerrno>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <functional>
+#include <future>
+#include <memory>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <atomic>
+#include <cstdlib>
+#include <iomanip>
+#include <limits>
+#include <new>
+#include <unordered_map>
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define CSV_SCAN_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CSV_SCAN_SSE2
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#include <io.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(WITH_BENCHMARKS)
+#include "../../../bench/bench_harness.h"
+#endif
+
+// Ядро токенизатора CSV: ищет разделители, кавычки и переводы строк блоками по 64 байта.
+// Для каждого блока строятся битовые маски (AVX2 — 2x32 байта, SSE2 — 4x16 байт),
+// на платформах без SIMD используется скалярный проход.
+class StructuralScanner {
+public:
+    static constexpr size_t kBlockSize = 64;
+
+    struct BlockMasks {
+        uint64_t delimiters;
+        uint64_t quotes;
+        uint64_t newlines;
+    };
+
+    explicit StructuralScanner(char delim = ',', char quoteChar = '"')
+        : delimiter(delim), quote(quoteChar) {}
+
+    char getDelimiter() const {
+        return delimiter;
+    }
+
+    // Маски для полного блока: требуется kBlockSize доступных байт.
+    BlockMasks scanBlock(const char* data) const {
+#if defined(CSV_SCAN_AVX2)
+        const __m256i delimiterVec = _mm256_set1_epi8(delimiter);
+        const __m256i quoteVec = _mm256_set1_epi8(quote);
+        const __m256i newlineVec = _mm256_set1_epi8('\n');
+        const __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+        const __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + 32));
+
+        auto mask = [&](__m256i needle) {
+            uint64_t low = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, needle)));
+            uint64_t high = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, needle)));
+            return low | (high << 32);
+        };
+
+        return { mask(delimiterVec), mask(quoteVec), mask(newlineVec) };
+#elif defined(CSV_SCAN_SSE2)
+        const __m128i delimiterVec = _mm_set1_epi8(delimiter);
+        const __m128i quoteVec = _mm_set1_epi8(quote);
+        const __m128i newlineVec = _mm_set1_epi8('\n');
+        BlockMasks masks{ 0, 0, 0 };
+
+        for (int lane = 0; lane < 4; ++lane) {
+            const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + lane * 16));
+            const int shift = lane * 16;
+            masks.delimiters |= static_cast<uint64_t>(
+                static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, delimiterVec)))) << shift;
+            masks.quotes |= static_cast<uint64_t>(
+                static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, quoteVec)))) << shift;
+            masks.newlines |= static_cast<uint64_t>(
+                static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, newlineVec)))) << shift;
+        }
+
+        return masks;
+#else
+        return scanTail(data, kBlockSize);
+#endif
+    }
+
+    // Скалярный вариант для хвоста короче блока.
+    BlockMasks scanTail(const char* data, size_t length) const {
+        BlockMasks masks{ 0, 0, 0 };
+        for (size_t i = 0; i < length; ++i) {
+            const uint64_t bit = uint64_t(1) << i;
+            if (data[i] == delimiter) masks.delimiters |= bit;
+            else if (data[i] == quote) masks.quotes |= bit;
+            else if (data[i] == '\n') masks.newlines |= bit;
+        }
+        return masks;
+    }
+
+    static unsigned lowestBit(uint64_t mask) {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+        unsigned long index;
+        _BitScanForward64(&index, mask);
+        return static_cast<unsigned>(index);
+#elif defined(_MSC_VER)
+        unsigned long index;
+        if (_BitScanForward(&index, static_cast<unsigned long>(mask))) {
+            return static_cast<unsigned>(index);
+        }
+        _BitScanForward(&index, static_cast<unsigned long>(mask >> 32));
+        return static_cast<unsigned>(index) + 32;
+#else
+        return static_cast<unsigned>(__builtin_ctzll(mask));
+#endif
+    }
+
+    // Разбивает текст на поля без учёта кавычек. onField(std::string_view) вызывается
+    // для каждого поля, onRecordEnd() — в конце каждой записи; если он вернёт false,
+    // разбор прекращается. '\r' перед переводом строки отбрасывается.
+    template <typename OnField, typename OnRecordEnd>
+    void tokenize(std::string_view input, OnField&& onField, OnRecordEnd&& onRecordEnd) const {
+        const char* data = input.data();
+        const size_t size = input.size();
+        size_t fieldStart = 0;
+
+        for (size_t block = 0; block < size; block += kBlockSize) {
+            const size_t length = std::min(kBlockSize, size - block);
+            const BlockMasks masks = length == kBlockSize ? scanBlock(data + block) : scanTail(data + block, length);
+            uint64_t structural = masks.delimiters | masks.newlines;
+
+            while (structural) {
+                const size_t pos = block + lowestBit(structural);
+                structural &= structural - 1;
+
+                if (data[pos] == '\n') {
+                    size_t fieldEnd = pos;
+                    if (fieldEnd > fieldStart && data[fieldEnd - 1] == '\r') {
+                        --fieldEnd;
+                    }
+                    onField(std::string_view(data + fieldStart, fieldEnd - fieldStart));
+                    fieldStart = pos + 1;
+                    if (!onRecordEnd()) {
+                        return;
+                    }
+                }
+                else {
+                    onField(std::string_view(data + fieldStart, pos - fieldStart));
+                    fieldStart = pos + 1;
+                }
+            }
+        }
+
+        if (fieldStart < size || (size > 0 && data[size - 1] == delimiter)) {
+            size_t fieldEnd = size;
+            if (fieldEnd > fieldStart && data[fieldEnd - 1] == '\r') {
+                --fieldEnd;
+            }
+            onField(std::string_view(data + fieldStart, fieldEnd - fieldStart));
+            onRecordEnd();
+        }
+    }
+
+    // Разбор по RFC 4180: поле в кавычках может содержать разделители и переводы строк,
+    // кавычка внутри экранируется удвоением. onField(std::string_view, bool escaped)
+    // получает содержимое поля без внешних кавычек; escaped == true, если в нём остались
+    // удвоенные кавычки, которые нужно свернуть.
+    template <typename OnField, typename OnRecordEnd>
+    void tokenizeQuoted(std::string_view input, OnField&& onField, OnRecordEnd&& onRecordEnd) const {
+        const char* data = input.data();
+        const size_t size = input.size();
+        size_t fieldStart = 0;
+        size_t closingQuote = 0;
+        bool inQuotes = false;
+        bool quoted = false;
+        bool escaped = false;
+
+        auto emit = [&](size_t fieldEnd) {
+            if (quoted) {
+                if (closingQuote + 1 != fieldEnd) {
+                    throw std::runtime_error("Invalid CSV format: unexpected character after quoted field");
+                }
+                onField(std::string_view(data + fieldStart + 1, closingQuote - fieldStart - 1), escaped);
+            }
+            else {
+                onField(std::string_view(data + fieldStart, fieldEnd - fieldStart), false);
+            }
+            quoted = false;
+            escaped = false;
+        };
+
+        for (size_t block = 0; block < size; block += kBlockSize) {
+            const size_t length = std::min(kBlockSize, size - block);
+            const BlockMasks masks = length == kBlockSize ? scanBlock(data + block) : scanTail(data + block, length);
+            uint64_t structural = masks.delimiters | masks.quotes | masks.newlines;
+
+            while (structural) {
+                const size_t pos = block + lowestBit(structural);
+                structural &= structural - 1;
+                const char c = data[pos];
+
+                if (c == quote) {
+                    if (inQuotes) {
+                        inQuotes = false;
+                        closingQuote = pos;
+                    }
+                    else if (quoted && pos == closingQuote + 1) {
+                        inQuotes = true;
+                        escaped = true;
+                    }
+                    else if (pos == fieldStart) {
+                        inQuotes = true;
+                        quoted = true;
+                    }
+                    else {
+                        throw std::runtime_error("Invalid CSV format: unexpected quote");
+                    }
+                }
+                else if (inQuotes) {
+                    continue;
+                }
+                else if (c == delimiter) {
+                    emit(pos);
+                    fieldStart = pos + 1;
+                }
+                else {
+                    size_t fieldEnd = pos;
+                    if (fieldEnd > fieldStart && data[fieldEnd - 1] == '\r') {
+                        --fieldEnd;
+                    }
+                    emit(fieldEnd);
+                    fieldStart = pos + 1;
+                    if (!onRecordEnd()) {
+                        return;
+                    }
+                }
+            }
+        }
+
+        if (inQuotes) {
+            throw std::runtime_error("Invalid CSV format: unterminated quoted field");
+        }
+
+        if (fieldStart < size || (size > 0 && data[size - 1] == delimiter)) {
+            size_t fieldEnd = size;
+            if (fieldEnd > fieldStart && data[fieldEnd - 1] == '\r') {
+                --fieldEnd;
+            }
+            emit(fieldEnd);
+            onRecordEnd();
+        }
+    }
+
+private:
+    char delimiter;
+    char quote;
+};
+
+
+
+// Файл, отображённый в память только для чтения, с подсказкой последовательного доступа.
+// Открывается один раз; дескриптор закрывается сразу после отображения.
+class MappedFile {
+public:
+    // Идентичность файла: устройство (том) и номер файла на нём
+    struct Identity {
+        uint64_t device = 0;
+        uint64_t index = 0;
+    };
+
+    MappedFile() = default;
+
+    explicit MappedFile(const std::string& filename) {
+#if defined(_WIN32)
+        HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+            nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            throw std::runtime_error("File not found: " + filename);
+        }
+
+        BY_HANDLE_FILE_INFORMATION fileInfo;
+        if (GetFileInformationByHandle(file, &fileInfo)) {
+            identity.device = fileInfo.dwVolumeSerialNumber;
+            identity.index = (static_cast<uint64_t>(fileInfo.nFileIndexHigh) << 32) | fileInfo.nFileIndexLow;
+        }
+
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize)) {
+            CloseHandle(file);
+            throw std::runtime_error("Failed to get file size: " + filename);
+        }
+        size = static_cast<size_t>(fileSize.QuadPart);
+
+        if (size > 0) {
+            HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (mapping != nullptr) {
+                data = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+                CloseHandle(mapping);
+            }
+        }
+        CloseHandle(file);
+#else
+        int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("File not found: " + filename);
+        }
+
+        struct stat info;
+        if (::fstat(fd, &info) != 0) {
+            ::close(fd);
+            throw std::runtime_error("Failed to get file size: " + filename);
+        }
+        size = static_cast<size_t>(info.st_size);
+        identity.device = static_cast<uint64_t>(info.st_dev);
+        identity.index = static_cast<uint64_t>(info.st_ino);
+
+        if (size > 0) {
+            void* address = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (address != MAP_FAILED) {
+                ::madvise(address, size, MADV_SEQUENTIAL);
+                data = static_cast<const char*>(address);
+            }
+        }
+        ::close(fd);
+#endif
+
+        if (size > 0 && data == nullptr) {
+            throw std::runtime_error("Failed to map file: " + filename);
+        }
+    }
+
+    MappedFile(MappedFile&& other) noexcept : data(other.data), size(other.size), identity(other.identity) {
+        other.data = nullptr;
+        other.size = 0;
+    }
+
+    MappedFile& operator=(MappedFile&& other) noexcept {
+        if (this != &other) {
+            release();
+            data = other.data;
+            size = other.size;
+            identity = other.identity;
+            other.data = nullptr;
+            other.size = 0;
+        }
+        return *this;
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile() {
+        release();
+    }
+
+    std::string_view view() const {
+        return std::string_view(data, size);
+    }
+
+    Identity getIdentity() const {
+        return identity;
+    }
+
+private:
+    const char* data = nullptr;
+    size_t size = 0;
+    Identity identity;
+
+    void release() {
+        if (data == nullptr) {
+            return;
+        }
+#if defined(_WIN32)
+        UnmapViewOfFile(data);
+#else
+        ::munmap(const_cast<char*>(data), size);
+#endif
+        data = nullptr;
+    }
+};
+
+// Таблица, ячейки которой указывают прямо в отображение файла.
+// Ячейки действительны, пока жив объект таблицы.
+class MappedTable {
+public:
+    // Индекс снимка TableSnapshot: смещения строк, концы ячеек и куча внутри отображения
+    struct SnapshotIndex {
+        const uint64_t* rows = nullptr;
+        const uint64_t* cellEnds = nullptr;
+        const char* heap = nullptr;
+        size_t rowCount = 0;
+        size_t cellCount = 0;
+        size_t heapSize = 0;
+    };
+
+    explicit MappedTable(MappedFile file) : source(std::move(file)) {
+        rowOffsets.push_back(0);
+    }
+
+    // Таблица только для чтения поверх снимка: ячейки читаются прямо из его массивов,
+    // так что открытие не зависит от числа ячеек.
+    static MappedTable fromSnapshot(MappedFile file, const SnapshotIndex& index) {
+        MappedTable table(std::move(file));
+        table.snapshot = index;
+        return table;
+    }
+
+    std::string_view text() const {
+        return source.view();
+    }
+
+    const MappedFile& file() const {
+        return source;
+    }
+
+    size_t rowCount() const {
+        return snapshot.rows != nullptr ? snapshot.rowCount : rowOffsets.size() - 1;
+    }
+
+    size_t cellCount(size_t row) const {
+        if (snapshot.rows != nullptr) {
+            if (snapshot.rows[row + 1] < snapshot.rows[row] || snapshot.rows[row + 1] > snapshot.cellCount) {
+                throw std::runtime_error("Corrupted snapshot: invalid row offsets");
+            }
+            return static_cast<size_t>(snapshot.rows[row + 1] - snapshot.rows[row]);
+        }
+        return rowOffsets[row + 1] - rowOffsets[row];
+    }
+
+    std::string_view cell(size_t row, size_t column) const {
+        if (row >= rowCount() || column >= cellCount(row)) {
+            throw std::out_of_range("Cell index out of range");
+        }
+        if (snapshot.rows != nullptr) {
+            const size_t index = static_cast<size_t>(snapshot.rows[row]) + column;
+            const uint64_t begin = index == 0 ? 0 : snapshot.cellEnds[index - 1];
+            const uint64_t end = snapshot.cellEnds[index];
+            if (begin > end || end > snapshot.heapSize) {
+                throw std::runtime_error("Corrupted snapshot: invalid cell offsets");
+            }
+            return std::string_view(snapshot.heap + begin, static_cast<size_t>(end - begin));
+        }
+        return cells[rowOffsets[row] + column];
+    }
+
+    bool empty() const {
+        return rowCount() == 0;
+    }
+
+    void addCell(std::string_view value) {
+        cells.push_back(value);
+    }
+
+    size_t pendingCells() const {
+        return cells.size() - rowOffsets.back();
+    }
+
+    void endRow() {
+        if (snapshot.rows != nullptr) {
+            throw std::logic_error("Snapshot table is read-only");
+        }
+        rowOffsets.push_back(cells.size());
+    }
+
+    // Сворачивает удвоенные кавычки; результат хранится в таблице.
+    std::string_view storeUnescaped(std::string_view value, char quote = '"') {
+        auto unescaped = std::make_unique<std::string>();
+        unescaped->reserve(value.size());
+        for (size_t i = 0; i < value.size(); ++i) {
+            unescaped->push_back(value[i]);
+            if (value[i] == quote && i + 1 < value.size() && value[i + 1] == quote) {
+                ++i;
+            }
+        }
+        ownedCells.push_back(std::move(unescaped));
+        return *ownedCells.back();
+    }
+
+    // Копия значения, которое не лежит в отображении файла; хранится в таблице.
+    std::string_view storeCopy(std::string_view value) {
+        ownedCells.push_back(std::make_unique<std::string>(value));
+        return *ownedCells.back();
+    }
+
+    // Переносит строки другой таблицы в конец этой; отображение источника
+    // при этом должно оставаться живым (его держит эта таблица).
+    void append(MappedTable&& other) {
+        if (snapshot.rows != nullptr || other.snapshot.rows != nullptr) {
+            throw std::logic_error("Snapshot table is read-only");
+        }
+        cells.insert(cells.end(), other.cells.begin(), other.cells.end());
+        for (size_t row = 1; row < other.rowOffsets.size(); ++row) {
+            rowOffsets.push_back(rowOffsets.back() + other.rowOffsets[row] - other.rowOffsets[row - 1]);
+        }
+        for (auto& owned : other.ownedCells) {
+            ownedCells.push_back(std::move(owned));
+        }
+        other.cells.clear();
+        other.rowOffsets.assign(1, 0);
+        other.ownedCells.clear();
+    }
+
+    std::vector<std::vector<std::string>> toStrings() const {
+        std::vector<std::vector<std::string>> data;
+        data.reserve(rowCount());
+        for (size_t row = 0; row < rowCount(); ++row) {
+            if (snapshot.rows != nullptr) {
+                std::vector<std::string>& values = data.emplace_back();
+                for (size_t column = 0; column < cellCount(row); ++column) {
+                    values.emplace_back(cell(row, column));
+                }
+            }
+            else {
+                data.emplace_back(cells.begin() + rowOffsets[row], cells.begin() + rowOffsets[row + 1]);
+            }
+        }
+        return data;
+    }
+
+private:
+    MappedFile source;
+    std::vector<std::string_view> cells;
+    std::vector<size_t> rowOffsets;
+    std::vector<std::unique_ptr<std::string>> ownedCells;
+    SnapshotIndex snapshot;
+};
+
+enum class ColumnType {
+    Int64,
+    Double,
+    String
+};
+
+// Типизированный столбец: значения лежат в непрерывном буфере своего типа,
+// строки кодируются словарём (куча + смещения), пустые ячейки отмечаются битовой картой NULL.
+// Смещения 64-битные: куча словаря большого файла может превышать 4 ГБ.
+class Column {
+public:
+    Column(std::string columnName, ColumnType columnType, size_t rows)
+        : name(std::move(columnName)), type(columnType), rowCount(rows), nullBitmap((rows + 63) / 64, 0) {
+        dictionaryOffsets.push_back(0);
+    }
+
+    const std::string& getName() const {
+        return name;
+    }
+
+    ColumnType getType() const {
+        return type;
+    }
+
+    size_t size() const {
+        return rowCount;
+    }
+
+    bool isNull(size_t row) const {
+        return (nullBitmap[row / 64] >> (row % 64)) & 1;
+    }
+
+    const std::vector<int64_t>& ints() const {
+        return intValues;
+    }
+
+    const std::vector<double>& doubles() const {
+        return doubleValues;
+    }
+
+    const std::vector<uint32_t>& codes() const {
+        return stringCodes;
+    }
+
+    size_t dictionarySize() const {
+        return dictionaryOffsets.size() - 1;
+    }
+
+    std::string_view dictionaryValue(uint32_t code) const {
+        return std::string_view(dictionaryHeap).substr(static_cast<size_t>(dictionaryOffsets[code]),
+            static_cast<size_t>(dictionaryOffsets[code + 1] - dictionaryOffsets[code]));
+    }
+
+    std::string_view getString(size_t row) const {
+        if (type != ColumnType::String) {
+            throw std::logic_error("Column is not a string column: " + name);
+        }
+        return dictionaryValue(stringCodes[row]);
+    }
+
+    double getNumber(size_t row) const {
+        switch (type) {
+        case ColumnType::Int64:
+            return static_cast<double>(intValues[row]);
+        case ColumnType::Double:
+            return doubleValues[row];
+        default:
+            throw std::logic_error("Column is not numeric: " + name);
+        }
+    }
+
+    static bool parseInt(std::string_view text, int64_t& value) {
+        auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+        return result.ec == std::errc() && result.ptr == text.data() + text.size();
+    }
+
+    static bool parseDouble(std::string_view text, double& value) {
+        auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+        return result.ec == std::errc() && result.ptr == text.data() + text.size();
+    }
+
+    class Builder;
+
+private:
+    std::string name;
+    ColumnType type;
+    size_t rowCount;
+    std::vector<uint64_t> nullBitmap;
+    std::vector<int64_t> intValues;
+    std::vector<double> doubleValues;
+    std::vector<uint32_t> stringCodes;
+    std::string dictionaryHeap;
+    std::vector<uint64_t> dictionaryOffsets;
+};
+
+// Строит столбец за один проход по ячейкам: тип уточняется по мере добавления значений.
+// Int64 -> Double переводит уже разобранные целые через static_cast — округление то же,
+// что у from_chars над исходным текстом. Переход в String перечитывает прежние ячейки
+// через cellAt(row); он случается не больше одного раза на столбец.
+// from_chars принимает "inf" и "nan", но такие ячейки делают столбец строковым.
+class Column::Builder {
+public:
+    Builder(std::string columnName, size_t rows)
+        : column(std::move(columnName), ColumnType::Int64, rows) {
+        column.intValues.reserve(rows);
+    }
+
+    template <typename CellAt>
+    void append(std::string_view value, CellAt&& cellAt) {
+        const size_t row = filled++;
+        if (value.empty()) {
+            column.nullBitmap[row / 64] |= uint64_t(1) << (row % 64);
+            appendDefault();
+            return;
+        }
+
+        switch (column.type) {
+        case ColumnType::Int64: {
+            int64_t intValue;
+            if (parseInt(value, intValue)) {
+                column.intValues.push_back(intValue);
+                return;
+            }
+            double doubleValue;
+            if (parseDouble(value, doubleValue) && std::isfinite(doubleValue)) {
+                convertToDouble();
+                column.doubleValues.push_back(doubleValue);
+                return;
+            }
+            convertToString(row, cellAt);
+            break;
+        }
+        case ColumnType::Double: {
+            double doubleValue;
+            if (parseDouble(value, doubleValue) && std::isfinite(doubleValue)) {
+                column.doubleValues.push_back(doubleValue);
+                return;
+            }
+            convertToString(row, cellAt);
+            break;
+        }
+        case ColumnType::String:
+            break;
+        }
+        appendString(value);
+    }
+
+    Column finish() {
+        return std::move(column);
+    }
+
+private:
+    void appendDefault() {
+        switch (column.type) {
+        case ColumnType::Int64:
+            column.intValues.push_back(0);
+            break;
+        case ColumnType::Double:
+            column.doubleValues.push_back(0.0);
+            break;
+        case ColumnType::String:
+            column.stringCodes.push_back(0);
+            break;
+        }
+    }
+
+    void appendString(std::string_view value) {
+        auto [it, inserted] = dictionary.emplace(value, static_cast<uint32_t>(column.dictionarySize()));
+        if (inserted) {
+            column.dictionaryHeap.append(value);
+            column.dictionaryOffsets.push_back(column.dictionaryHeap.size());
+        }
+        column.stringCodes.push_back(it->second);
+    }
+
+    void convertToDouble() {
+        column.doubleValues.reserve(column.rowCount);
+        for (int64_t value : column.intValues) {
+            column.doubleValues.push_back(static_cast<double>(value));
+        }
+        std::vector<int64_t>().swap(column.intValues);
+        column.type = ColumnType::Double;
+    }
+
+    template <typename CellAt>
+    void convertToString(size_t rows, CellAt& cellAt) {
+        std::vector<int64_t>().swap(column.intValues);
+        std::vector<double>().swap(column.doubleValues);
+        column.type = ColumnType::String;
+        column.stringCodes.reserve(column.rowCount);
+        for (size_t row = 0; row < rows; ++row) {
+            if (column.isNull(row)) {
+                column.stringCodes.push_back(0);
+            }
+            else {
+                appendString(cellAt(row));
+            }
+        }
+    }
+
+    Column column;
+    size_t filled = 0;
+    std::unordered_map<std::string_view, uint32_t> dictionary;
+};
+
+// Таблица по столбцам: первая строка источника — заголовки.
+class ColumnarTable {
+public:
+    static ColumnarTable fromMapped(const MappedTable& table) {
+        ColumnarTable result;
+        if (table.empty()) {
+            return result;
+        }
+
+        const size_t columnCount = table.cellCount(0);
+        const size_t rows = table.rowCount() - 1;
+        std::vector<Column::Builder> builders;
+        builders.reserve(columnCount);
+        for (size_t column = 0; column < columnCount; ++column) {
+            builders.emplace_back(std::string(table.cell(0, column)), rows);
+        }
+
+        for (size_t row = 1; row < table.rowCount(); ++row) {
+            const size_t cells = table.cellCount(row);
+            if (cells > columnCount) {
+                throw std::runtime_error("Row " + std::to_string(row) + " has more cells than headers");
+            }
+            for (size_t column = 0; column < columnCount; ++column) {
+                builders[column].append(column < cells ? table.cell(row, column) : std::string_view(),
+                    [&](size_t previous) {
+                        return column < table.cellCount(previous + 1) ? table.cell(previous + 1, column) : std::string_view();
+                    });
+            }
+        }
+
+        result.rowCount = rows;
+        result.columns.reserve(columnCount);
+        for (auto& builder : builders) {
+            result.columns.push_back(builder.finish());
+        }
+
+        return result;
+    }
+
+    size_t getRowCount() const {
+        return rowCount;
+    }
+
+    size_t getColumnCount() const {
+        return columns.size();
+    }
+
+    const Column& column(size_t index) const {
+        return columns.at(index);
+    }
+
+    const Column& column(const std::string& name) const {
+        for (const auto& column : columns) {
+            if (column.getName() == name) {
+                return column;
+            }
+        }
+        throw std::out_of_range("Unknown column: " + name);
+    }
+
+private:
+    size_t rowCount = 0;
+    std::vector<Column> columns;
+};
+
+enum class CompareOp {
+    Equal,
+    NotEqual,
+    Less,
+    LessEqual,
+    Greater,
+    GreaterEqual
+};
+
+enum class AggregateFunction {
+    Count,
+    Sum,
+    Min,
+    Max,
+    Avg
+};
+
+// Результат запроса: имена столбцов и строки значений в текстовом виде
+struct QueryResult {
+    std::vector<std::string> columns;
+    std::vector<std::vector<std::string>> rows;
+};
+
+// Встроенный запрос над ColumnarTable: фильтры (объединяются через И), проекция,
+// группировка по хешу с count/sum/min/max/avg и top-k через orderBy + limit.
+// Выполнение векторное: строки обрабатываются пачками по kBatchSize, каждый фильтр
+// проходит по столбцу и сужает вектор выбранных строк. Диапазоны строк делятся между
+// потоками, каждый поток агрегирует в свою хеш-таблицу, частичные результаты сливаются.
+// Строковые условия заранее вычисляются для каждого кода словаря, поэтому проверка
+// строки — одно обращение к таблице. NULL не проходит ни одно условие.
+class TableQuery {
+public:
+    static constexpr size_t kBatchSize = 1024;
+
+    explicit TableQuery(const ColumnarTable& source) : table(source) {}
+
+    TableQuery& where(const std::string& column, CompareOp op, std::string value) {
+        predicates.push_back({ column, op, std::move(value) });
+        return *this;
+    }
+
+    TableQuery& select(std::vector<std::string> columns) {
+        projection = std::move(columns);
+        return *this;
+    }
+
+    TableQuery& groupBy(std::vector<std::string> columns) {
+        groupColumns = std::move(columns);
+        return *this;
+    }
+
+    // Для Count пустое имя столбца означает count(*)
+    TableQuery& aggregate(AggregateFunction function, const std::string& column = "") {
+        aggregates.push_back({ function, column });
+        return *this;
+    }
+
+    // Сортировка результата по столбцу вывода; для агрегатов — по имени вида "avg(Age)"
+    TableQuery& orderBy(const std::string& column, bool descending = false) {
+        orderColumn = column;
+        orderDescending = descending;
+        return *this;
+    }
+
+    TableQuery& limit(size_t count) {
+        rowLimit = count;
+        return *this;
+    }
+
+    TableQuery& threads(unsigned count) {
+        threadCount = count == 0 ? 1 : count;
+        return *this;
+    }
+
+    QueryResult run() const {
+        if (table.getRowCount() > UINT32_MAX) {
+            throw std::runtime_error("Table is too large for TableQuery");
+        }
+        std::vector<CompiledPredicate> compiled;
+        for (const auto& predicate : predicates) {
+            compiled.push_back(compile(predicate));
+        }
+        return aggregates.empty() && groupColumns.empty() ? runProjection(compiled) : runAggregation(compiled);
+    }
+
+private:
+    struct Predicate {
+        std::string column;
+        CompareOp op;
+        std::string value;
+    };
+
+    struct AggregateSpec {
+        AggregateFunction function;
+        std::string column;
+    };
+
+    // Для столбца Int64 целая граница сравнивается как int64_t (integral),
+    // дробная — как double.
+    struct CompiledPredicate {
+        const Column* column;
+        CompareOp op;
+        double number;
+        int64_t integer;
+        bool integral;
+        std::vector<uint8_t> codeMatches;
+    };
+
+    // Для столбцов Int64 сумма и экстремумы копятся в int64_t без потери точности
+    // выше 2^53, для Double — в double. Сумма Int64 хранится как intCarry * 2^64 + intSum:
+    // при переполнении intSum заворачивается, а перенос считается в intCarry.
+    struct Accumulator {
+        uint64_t count = 0;
+        double sum = 0.0;
+        double min = std::numeric_limits<double>::infinity();
+        double max = -std::numeric_limits<double>::infinity();
+        int64_t intSum = 0;
+        int64_t intCarry = 0;
+        int64_t intMin = std::numeric_limits<int64_t>::max();
+        int64_t intMax = std::numeric_limits<int64_t>::min();
+
+        void addInteger(int64_t value) {
+            intCarry += addWithCarry(intSum, value);
+        }
+
+        void mergeInteger(const Accumulator& other) {
+            addInteger(other.intSum);
+            intCarry += other.intCarry;
+        }
+
+        double integerSum() const {
+            return static_cast<double>(intCarry) * 18446744073709551616.0 + static_cast<double>(intSum);
+        }
+    };
+
+    // total += value по модулю 2^64; возвращает перенос: +1, -1 или 0.
+    static int addWithCarry(int64_t& total, int64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+        if (!__builtin_add_overflow(total, value, &total)) {
+            return 0;
+        }
+#else
+        const int64_t before = total;
+        total = static_cast<int64_t>(static_cast<uint64_t>(before) + static_cast<uint64_t>(value));
+        if ((value >= 0) == (total >= before)) {
+            return 0;
+        }
+#endif
+        return value < 0 ? -1 : 1;
+    }
+
+    // Хеш-таблица групп с открытой адресацией: ключ — width значений int64
+    // (код словаря, число или биты double) и маска NULL в последнем слоте.
+    class GroupTable {
+    public:
+        explicit GroupTable(size_t keyWidth) : width(keyWidth + 1), slots(64, 0) {}
+
+        uint32_t findOrInsert(const int64_t* key) {
+            if ((groupCount + 1) * 2 > slots.size()) {
+                grow();
+            }
+            const size_t mask = slots.size() - 1;
+            for (size_t index = hash(key) & mask;; index = (index + 1) & mask) {
+                const uint32_t slot = slots[index];
+                if (slot == 0) {
+                    keys.insert(keys.end(), key, key + width);
+                    slots[index] = static_cast<uint32_t>(++groupCount);
+                    return slots[index] - 1;
+                }
+                if (std::equal(key, key + width, keys.data() + (slot - 1) * width)) {
+                    return slot - 1;
+                }
+            }
+        }
+
+        size_t size() const {
+            return groupCount;
+        }
+
+        const int64_t* key(size_t group) const {
+            return keys.data() + group * width;
+        }
+
+    private:
+        size_t width;
+        std::vector<int64_t> keys;
+        std::vector<uint32_t> slots;
+        size_t groupCount = 0;
+
+        uint64_t hash(const int64_t* key) const {
+            uint64_t h = 0x9E3779B97F4A7C15ull;
+            for (size_t i = 0; i < width; ++i) {
+                h ^= static_cast<uint64_t>(key[i]) + 0x9E3779B97F4A7C15ull + (h << 6) + (h >> 2);
+                h *= 0xBF58476D1CE4E5B9ull;
+            }
+            return h ^ (h >> 31);
+        }
+
+        void grow() {
+            std::vector<uint32_t> resized(slots.size() * 2, 0);
+            const size_t mask = resized.size() - 1;
+            for (size_t group = 0; group < groupCount; ++group) {
+                size_t index = hash(key(group)) & mask;
+                while (resized[index] != 0) {
+                    index = (index + 1) & mask;
+                }
+                resized[index] = static_cast<uint32_t>(group + 1);
+            }
+            slots.swap(resized);
+        }
+    };
+
+    const ColumnarTable& table;
+    std::vector<Predicate> predicates;
+    std::vector<std::string> projection;
+    std::vector<std::string> groupColumns;
+    std::vector<AggregateSpec> aggregates;
+    std::string orderColumn;
+    bool orderDescending = false;
+    size_t rowLimit = std::numeric_limits<size_t>::max();
+    unsigned threadCount = std::thread::hardware_concurrency() == 0 ? 1 : std::thread::hardware_concurrency();
+
+    template <typename T>
+    static bool compare(CompareOp op, const T& left, const T& right) {
+        switch (op) {
+        case CompareOp::Equal: return left == right;
+        case CompareOp::NotEqual: return left != right;
+        case CompareOp::Less: return left < right;
+        case CompareOp::LessEqual: return left <= right;
+        case CompareOp::Greater: return left > right;
+        default: return left >= right;
+        }
+    }
+
+    CompiledPredicate compile(const Predicate& predicate) const {
+        CompiledPredicate compiled{ &table.column(predicate.column), predicate.op, 0.0, 0, false, {} };
+        if (compiled.column->getType() == ColumnType::String) {
+            compiled.codeMatches.resize(compiled.column->dictionarySize());
+            for (uint32_t code = 0; code < compiled.codeMatches.size(); ++code) {
+                compiled.codeMatches[code] = compare(predicate.op, compiled.column->dictionaryValue(code),
+                    std::string_view(predicate.value));
+            }
+        }
+        else if (compiled.column->getType() == ColumnType::Int64 &&
+            Column::parseInt(predicate.value, compiled.integer)) {
+            compiled.integral = true;
+        }
+        else if (!Column::parseDouble(predicate.value, compiled.number)) {
+            throw std::invalid_argument("Predicate value is not a number: " + predicate.value);
+        }
+        return compiled;
+    }
+
+    // Оставляет в selection только строки, прошедшие условие; возвращает их число.
+    static size_t filter(const CompiledPredicate& predicate, uint32_t* selection, size_t count) {
+        const Column& column = *predicate.column;
+        size_t kept = 0;
+        auto keep = [&](auto&& matches) {
+            for (size_t i = 0; i < count; ++i) {
+                const uint32_t row = selection[i];
+                selection[kept] = row;
+                kept += matches(row) && !column.isNull(row);
+            }
+        };
+        auto numeric = [&](const auto* values, auto bound) {
+            using Bound = decltype(bound);
+            switch (predicate.op) {
+            case CompareOp::Equal: keep([&](uint32_t row) { return static_cast<Bound>(values[row]) == bound; }); break;
+            case CompareOp::NotEqual: keep([&](uint32_t row) { return static_cast<Bound>(values[row]) != bound; }); break;
+            case CompareOp::Less: keep([&](uint32_t row) { return static_cast<Bound>(values[row]) < bound; }); break;
+            case CompareOp::LessEqual: keep([&](uint32_t row) { return static_cast<Bound>(values[row]) <= bound; }); break;
+            case CompareOp::Greater: keep([&](uint32_t row) { return static_cast<Bound>(values[row]) > bound; }); break;
+            case CompareOp::GreaterEqual: keep([&](uint32_t row) { return static_cast<Bound>(values[row]) >= bound; }); break;
+            }
+        };
+
+        switch (column.getType()) {
+        case ColumnType::Int64:
+            if (predicate.integral) {
+                numeric(column.ints().data(), predicate.integer);
+            }
+            else {
+                numeric(column.ints().data(), predicate.number);
+            }
+            break;
+        case ColumnType::Double:
+            numeric(column.doubles().data(), predicate.number);
+            break;
+        case ColumnType::String: {
+            const uint32_t* codes = column.codes().data();
+            const uint8_t* matches = predicate.codeMatches.data();
+            keep([&](uint32_t row) { return matches[codes[row]] != 0; });
+            break;
+        }
+        }
+        return kept;
+    }
+
+    // Прогоняет диапазоны строк через фильтры в нескольких потоках;
+    // consume(thread, selection, count) получает выбранные строки пачки.
+    template <typename Consume>
+    size_t scan(const std::vector<CompiledPredicate>& compiled, Consume&& consume) const {
+        static constexpr size_t kMinRowsPerThread = 64 * 1024;
+        const size_t rows = table.getRowCount();
+        const size_t workerCount = std::max<size_t>(1, std::min<size_t>(threadCount, rows / kMinRowsPerThread));
+        const size_t rowsPerWorker = ((rows + workerCount - 1) / workerCount + kBatchSize - 1) / kBatchSize * kBatchSize;
+
+        std::vector<std::exception_ptr> errors(workerCount);
+        auto work = [&](size_t worker) {
+            try {
+                std::vector<uint32_t> selection(kBatchSize);
+                const size_t end = std::min(rows, (worker + 1) * rowsPerWorker);
+                for (size_t begin = worker * rowsPerWorker; begin < end; begin += kBatchSize) {
+                    size_t count = std::min(kBatchSize, end - begin);
+                    for (size_t i = 0; i < count; ++i) {
+                        selection[i] = static_cast<uint32_t>(begin + i);
+                    }
+                    for (const auto& predicate : compiled) {
+                        count = filter(predicate, selection.data(), count);
+                        if (count == 0) {
+                            break;
+                        }
+                    }
+                    if (count > 0) {
+                        consume(worker, selection.data(), count);
+                    }
+                }
+            }
+            catch (...) {
+                errors[worker] = std::current_exception();
+            }
+        };
+
+        std::vector<std::thread> workers;
+        for (size_t worker = 1; worker < workerCount; ++worker) {
+            workers.emplace_back(work, worker);
+        }
+        work(0);
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        for (auto& error : errors) {
+            if (error) {
+                std::rethrow_exception(error);
+            }
+        }
+        return workerCount;
+    }
+
+    // Ранг каждого кода словаря в лексикографическом порядке — ключ сортировки строк
+    static std::vector<double> dictionaryRanks(const Column& column) {
+        std::vector<uint32_t> codes(column.dictionarySize());
+        for (uint32_t code = 0; code < codes.size(); ++code) {
+            codes[code] = code;
+        }
+        std::sort(codes.begin(), codes.end(), [&](uint32_t left, uint32_t right) {
+            return column.dictionaryValue(left) < column.dictionaryValue(right);
+        });
+        std::vector<double> ranks(codes.size());
+        for (size_t rank = 0; rank < codes.size(); ++rank) {
+            ranks[codes[rank]] = static_cast<double>(rank);
+        }
+        return ranks;
+    }
+
+    static std::string formatNumber(double value) {
+        char text[32];
+        auto result = std::to_chars(text, text + sizeof(text), value);
+        return std::string(text, result.ptr);
+    }
+
+    static std::string formatCell(const Column& column, size_t row) {
+        if (column.isNull(row)) {
+            return std::string();
+        }
+        switch (column.getType()) {
+        case ColumnType::Int64: return std::to_string(column.ints()[row]);
+        case ColumnType::Double: return formatNumber(column.doubles()[row]);
+        default: return std::string(column.getString(row));
+        }
+    }
+
+    // Сортирует индексы по ключу (NULL и NaN в конце), при limit — только первые k.
+    void orderAndLimit(std::vector<std::pair<double, size_t>>& items) const {
+        auto less = [&](const std::pair<double, size_t>& left, const std::pair<double, size_t>& right) {
+            const bool leftMissing = std::isnan(left.first);
+            const bool rightMissing = std::isnan(right.first);
+            if (leftMissing != rightMissing) {
+                return rightMissing;
+            }
+            if (!leftMissing && left.first != right.first) {
+                return orderDescending ? left.first > right.first : left.first < right.first;
+            }
+            return left.second < right.second;
+        };
+        if (rowLimit < items.size()) {
+            std::partial_sort(items.begin(), items.begin() + rowLimit, items.end(), less);
+            items.resize(rowLimit);
+        }
+        else {
+            std::sort(items.begin(), items.end(), less);
+        }
+    }
+
+    QueryResult runProjection(const std::vector<CompiledPredicate>& compiled) const {
+        std::vector<const Column*> output;
+        QueryResult result;
+        if (projection.empty()) {
+            for (size_t i = 0; i < table.getColumnCount(); ++i) {
+                output.push_back(&table.column(i));
+            }
+        }
+        else {
+            for (const auto& name : projection) {
+                output.push_back(&table.column(name));
+            }
+        }
+        for (const Column* column : output) {
+            result.columns.push_back(column->getName());
+        }
+
+        const Column* orderBy = orderColumn.empty() ? nullptr : &table.column(orderColumn);
+        const std::vector<double> ranks = orderBy && orderBy->getType() == ColumnType::String
+            ? dictionaryRanks(*orderBy) : std::vector<double>();
+        auto sortKey = [&](uint32_t row) {
+            if (orderBy->isNull(row)) {
+                return std::numeric_limits<double>::quiet_NaN();
+            }
+            return orderBy->getType() == ColumnType::String ? ranks[orderBy->codes()[row]] : orderBy->getNumber(row);
+        };
+
+        // Каждый поток копит кандидатов и периодически оставляет только limit лучших
+        std::vector<std::vector<std::pair<double, size_t>>> partial(threadCount);
+        scan(compiled, [&](size_t worker, const uint32_t* selection, size_t count) {
+            auto& items = partial[worker];
+            for (size_t i = 0; i < count; ++i) {
+                if (!orderBy && items.size() >= rowLimit) {
+                    return;
+                }
+                items.emplace_back(orderBy ? sortKey(selection[i]) : 0.0, selection[i]);
+            }
+            if (orderBy && items.size() >= 2 * std::max<size_t>(rowLimit, kBatchSize)) {
+                orderAndLimit(items);
+            }
+        });
+
+        std::vector<std::pair<double, size_t>> rows;
+        for (auto& items : partial) {
+            rows.insert(rows.end(), items.begin(), items.end());
+        }
+        orderAndLimit(rows);
+
+        result.rows.reserve(rows.size());
+        for (const auto& item : rows) {
+            std::vector<std::string> cells;
+            cells.reserve(output.size());
+            for (const Column* column : output) {
+                cells.push_back(formatCell(*column, item.second));
+            }
+            result.rows.push_back(std::move(cells));
+        }
+        return result;
+    }
+
+    QueryResult runAggregation(const std::vector<CompiledPredicate>& compiled) const {
+        std::vector<const Column*> keys;
+        for (const auto& name : groupColumns) {
+            keys.push_back(&table.column(name));
+        }
+        std::vector<const Column*> inputs;
+        QueryResult result = { groupColumns, {} };
+        static const char* const kNames[] = { "count", "sum", "min", "max", "avg" };
+        for (const auto& spec : aggregates) {
+            const Column* column = spec.column.empty() ? nullptr : &table.column(spec.column);
+            if (column == nullptr && spec.function != AggregateFunction::Count) {
+                throw std::invalid_argument("Aggregate requires a column");
+            }
+            if (column && column->getType() == ColumnType::String && spec.function != AggregateFunction::Count) {
+                throw std::invalid_argument("Aggregate requires a numeric column: " + spec.column);
+            }
+            inputs.push_back(column);
+            result.columns.push_back(std::string(kNames[static_cast<int>(spec.function)]) + "(" +
+                (spec.column.empty() ? "*" : spec.column) + ")");
+        }
+
+        const size_t keyWidth = keys.size();
+        const size_t aggregateCount = aggregates.size();
+        std::vector<GroupTable> groupTables(threadCount, GroupTable(keyWidth));
+        std::vector<std::vector<Accumulator>> accumulators(threadCount);
+
+        const size_t workers = scan(compiled, [&](size_t worker, const uint32_t* selection, size_t count) {
+            GroupTable& groups = groupTables[worker];
+            auto& states = accumulators[worker];
+            uint32_t groupIds[kBatchSize];
+            int64_t key[64];
+            if (keyWidth + 1 > 64) {
+                throw std::invalid_argument("Too many group-by columns");
+            }
+
+            for (size_t i = 0; i < count; ++i) {
+                const uint32_t row = selection[i];
+                int64_t nullMask = 0;
+                for (size_t k = 0; k < keyWidth; ++k) {
+                    const Column& column = *keys[k];
+                    if (column.isNull(row)) {
+                        nullMask |= int64_t(1) << k;
+                        key[k] = 0;
+                        continue;
+                    }
+                    switch (column.getType()) {
+                    case ColumnType::Int64: key[k] = column.ints()[row]; break;
+                    case ColumnType::Double: std::memcpy(&key[k], &column.doubles()[row], sizeof(double)); break;
+                    case ColumnType::String: key[k] = column.codes()[row]; break;
+                    }
+                }
+                key[keyWidth] = nullMask;
+                groupIds[i] = groups.findOrInsert(key);
+            }
+            states.resize(groups.size() * aggregateCount);
+
+            // Агрегаты обновляются по столбцу целиком для всей пачки
+            for (size_t a = 0; a < aggregateCount; ++a) {
+                const Column* column = inputs[a];
+                Accumulator* state = states.data() + a;
+                if (column == nullptr || column->getType() == ColumnType::String) {
+                    for (size_t i = 0; i < count; ++i) {
+                        state[groupIds[i] * aggregateCount].count += column == nullptr || !column->isNull(selection[i]);
+                    }
+                    continue;
+                }
+                auto update = [&](const auto* values) {
+                    for (size_t i = 0; i < count; ++i) {
+                        const uint32_t row = selection[i];
+                        if (column->isNull(row)) {
+                            continue;
+                        }
+                        const auto value = values[row];
+                        Accumulator& target = state[groupIds[i] * aggregateCount];
+                        ++target.count;
+                        if constexpr (std::is_integral_v<std::decay_t<decltype(value)>>) {
+                            target.addInteger(value);
+                            target.intMin = std::min(target.intMin, value);
+                            target.intMax = std::max(target.intMax, value);
+                        }
+                        else {
+                            target.sum += value;
+                            target.min = std::min(target.min, value);
+                            target.max = std::max(target.max, value);
+                        }
+                    }
+                };
+                if (column->getType() == ColumnType::Int64) {
+                    update(column->ints().data());
+                }
+                else {
+                    update(column->doubles().data());
+                }
+            }
+        });
+
+        auto isInteger = [&](size_t a) {
+            return inputs[a] != nullptr && inputs[a]->getType() == ColumnType::Int64;
+        };
+
+        // Слияние частичных агрегатов потоков
+        GroupTable merged(keyWidth);
+        std::vector<Accumulator> totals;
+        if (keyWidth == 0) {
+            int64_t emptyKey = 0;
+            merged.findOrInsert(&emptyKey);
+            totals.resize(aggregateCount);
+        }
+        for (size_t worker = 0; worker < workers; ++worker) {
+            const GroupTable& groups = groupTables[worker];
+            for (size_t group = 0; group < groups.size(); ++group) {
+                const uint32_t target = merged.findOrInsert(groups.key(group));
+                totals.resize(merged.size() * aggregateCount);
+                for (size_t a = 0; a < aggregateCount; ++a) {
+                    const Accumulator& from = accumulators[worker][group * aggregateCount + a];
+                    Accumulator& to = totals[target * aggregateCount + a];
+                    to.count += from.count;
+                    if (isInteger(a)) {
+                        to.mergeInteger(from);
+                    }
+                    else {
+                        to.sum += from.sum;
+                    }
+                    to.min = std::min(to.min, from.min);
+                    to.max = std::max(to.max, from.max);
+                    to.intMin = std::min(to.intMin, from.intMin);
+                    to.intMax = std::max(to.intMax, from.intMax);
+                }
+            }
+        }
+
+        // Точное значение sum/min/max для столбца Int64
+        auto integerValue = [&](size_t group, size_t a) {
+            const Accumulator& state = totals[group * aggregateCount + a];
+            switch (aggregates[a].function) {
+            case AggregateFunction::Min: return state.intMin;
+            case AggregateFunction::Max: return state.intMax;
+            default: return state.intSum;
+            }
+        };
+        // Можно ли вывести агрегат как целое: не avg и не сумма за пределами int64_t
+        auto isExactInteger = [&](size_t group, size_t a) {
+            const AggregateFunction function = aggregates[a].function;
+            return isInteger(a) && function != AggregateFunction::Avg &&
+                !(function == AggregateFunction::Sum && totals[group * aggregateCount + a].intCarry != 0);
+        };
+        auto aggregateValue = [&](size_t group, size_t a) {
+            const Accumulator& state = totals[group * aggregateCount + a];
+            const double missing = std::numeric_limits<double>::quiet_NaN();
+            switch (aggregates[a].function) {
+            case AggregateFunction::Count:
+                return static_cast<double>(state.count);
+            case AggregateFunction::Avg:
+                return state.count == 0 ? missing
+                    : (isInteger(a) ? state.integerSum() : state.sum) / state.count;
+            default:
+                if (aggregates[a].function != AggregateFunction::Sum && state.count == 0) {
+                    return missing;
+                }
+                return isExactInteger(group, a) ? static_cast<double>(integerValue(group, a))
+                    : isInteger(a) ? state.integerSum()
+                    : aggregates[a].function == AggregateFunction::Sum ? state.sum
+                    : aggregates[a].function == AggregateFunction::Min ? state.min : state.max;
+            }
+        };
+
+        std::vector<std::pair<double, size_t>> order(merged.size());
+        auto orderIt = std::find(result.columns.begin(), result.columns.end(), orderColumn);
+        if (!orderColumn.empty() && orderIt == result.columns.end()) {
+            throw std::out_of_range("Unknown output column: " + orderColumn);
+        }
+        const size_t orderIndex = static_cast<size_t>(orderIt - result.columns.begin());
+        const std::vector<double> ranks = orderIndex < keyWidth && keys[orderIndex]->getType() == ColumnType::String
+            ? dictionaryRanks(*keys[orderIndex]) : std::vector<double>();
+        for (size_t group = 0; group < merged.size(); ++group) {
+            double sortKey = 0.0;
+            if (orderColumn.empty()) {
+                sortKey = 0.0;
+            }
+            else if (orderIndex >= keyWidth) {
+                sortKey = aggregateValue(group, orderIndex - keyWidth);
+            }
+            else if ((merged.key(group)[keyWidth] >> orderIndex) & 1) {
+                sortKey = std::numeric_limits<double>::quiet_NaN();
+            }
+            else {
+                const int64_t value = merged.key(group)[orderIndex];
+                switch (keys[orderIndex]->getType()) {
+                case ColumnType::Int64: sortKey = static_cast<double>(value); break;
+                case ColumnType::Double: std::memcpy(&sortKey, &value, sizeof(double)); break;
+                case ColumnType::String: sortKey = ranks[static_cast<size_t>(value)]; break;
+                }
+            }
+            order[group] = { sortKey, group };
+        }
+        orderAndLimit(order);
+
+        for (const auto& item : order) {
+            const size_t group = item.second;
+            const int64_t* key = merged.key(group);
+            std::vector<std::string> cells;
+            for (size_t k = 0; k < keyWidth; ++k) {
+                if ((key[keyWidth] >> k) & 1) {
+                    cells.emplace_back();
+                    continue;
+                }
+                switch (keys[k]->getType()) {
+                case ColumnType::Int64:
+                    cells.push_back(std::to_string(key[k]));
+                    break;
+                case ColumnType::Double: {
+                    double value;
+                    std::memcpy(&value, &key[k], sizeof(double));
+                    cells.push_back(formatNumber(value));
+                    break;
+                }
+                case ColumnType::String:
+                    cells.emplace_back(keys[k]->dictionaryValue(static_cast<uint32_t>(key[k])));
+                    break;
+                }
+            }
+            for (size_t a = 0; a < aggregateCount; ++a) {
+                const double value = aggregateValue(group, a);
+                if (std::isnan(value)) {
+                    cells.emplace_back();
+                }
+                else if (aggregates[a].function == AggregateFunction::Count) {
+                    cells.push_back(std::to_string(totals[group * aggregateCount + a].count));
+                }
+                else if (isExactInteger(group, a)) {
+                    cells.push_back(std::to_string(integerValue(group, a)));
+                }
+                else {
+                    cells.push_back(formatNumber(value));
+                }
+            }
+            result.rows.push_back(std::move(cells));
+        }
+        return result;
+    }
+};
+
+// Контрольная точка режима дозаписи: смещение сразу после последней полной записи,
+// идентичность файла и хеш его начала, по которым обнаруживаются ротация и перезапись.
+struct ReadCheckpoint {
+    static constexpr size_t kSignatureBytes = 4096;
+
+    uint64_t offset = 0;
+    uint64_t device = 0;
+    uint64_t fileIndex = 0;
+    uint64_t signatureLength = 0;
+    uint64_t signature = 0;
+    uint64_t columns = 0;
+
+    // Не сохраняется: последний вызов начал чтение с начала файла (строка заголовка снова в выдаче)
+    bool fromStart = false;
+
+    // Отсутствующий файл даёт пустую точку (чтение с начала)
+    static ReadCheckpoint load(const std::string& path) {
+        ReadCheckpoint checkpoint;
+        std::ifstream file(path);
+        if (!file) {
+            return checkpoint;
+        }
+        if (!(file >> checkpoint.offset >> checkpoint.device >> checkpoint.fileIndex
+            >> checkpoint.signatureLength >> checkpoint.signature >> checkpoint.columns)) {
+            throw std::runtime_error("Corrupted checkpoint file: " + path);
+        }
+        return checkpoint;
+    }
+
+    // Запись через временный файл и переименование, чтобы сбой не оставил половину точки
+    void save(const std::string& path) const {
+        const std::string temporary = path + ".tmp";
+        {
+            std::ofstream file(temporary, std::ios::trunc);
+            file << offset << ' ' << device << ' ' << fileIndex << ' '
+                << signatureLength << ' ' << signature << ' ' << columns << '\n';
+            if (!file.flush()) {
+                throw std::runtime_error("Failed to write checkpoint file: " + path);
+            }
+        }
+#if defined(_WIN32)
+        const bool renamed = MoveFileExA(temporary.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+        const bool renamed = std::rename(temporary.c_str(), path.c_str()) == 0;
+#endif
+        if (!renamed) {
+            throw std::runtime_error("Failed to write checkpoint file: " + path);
+        }
+    }
+
+    static uint64_t hashPrefix(std::string_view text, size_t length) {
+        uint64_t hash = 14695981039346656037ull;
+        for (size_t i = 0; i < length; ++i) {
+            hash = (hash ^ static_cast<unsigned char>(text[i])) * 1099511628211ull;
+        }
+        return hash;
+    }
+
+    // Тот же файл, не усечён и начало не переписано
+    bool matches(const MappedFile::Identity& identity, std::string_view text) const {
+        return identity.device == device && identity.index == fileIndex && offset <= text.size() &&
+            signatureLength <= text.size() && hashPrefix(text, signatureLength) == signature;
+    }
+};
+
+// Бинарный снимок разобранной таблицы. Формат (числа — uint64 в порядке байт машины):
+// заголовок, смещения строк [rowCount + 1], концы ячеек в куче [cellCount], куча строк.
+// Снимок отображается в память, таблица читает ячейки прямо из его массивов и кучи.
+class TableSnapshot {
+public:
+    // Ключ снимка: путь источника, формат чтения, размер и время изменения файла
+    struct SourceStamp {
+        uint64_t pathHash = 0;
+        uint64_t size = 0;
+        int64_t modified = 0;
+
+        static SourceStamp of(const std::string& filename, std::string_view format) {
+            namespace fs = std::filesystem;
+            std::error_code error;
+            const fs::path path = fs::absolute(filename, error);
+            SourceStamp stamp;
+            stamp.pathHash = ReadCheckpoint::hashPrefix(format, format.size()) ^
+                ReadCheckpoint::hashPrefix(path.string(), path.string().size());
+            stamp.size = fs::file_size(path, error);
+            if (error) {
+                throw std::runtime_error("File not found: " + filename);
+            }
+            stamp.modified = static_cast<int64_t>(fs::last_write_time(path, error).time_since_epoch().count());
+            return stamp;
+        }
+
+        bool operator==(const SourceStamp& other) const {
+            return pathHash == other.pathHash && size == other.size && modified == other.modified;
+        }
+    };
+
+    static std::string pathFor(const std::string& cacheDirectory, const SourceStamp& stamp) {
+        char name[32];
+        std::snprintf(name, sizeof(name), "%016llx.snap", static_cast<unsigned long long>(stamp.pathHash));
+        return (std::filesystem::path(cacheDirectory) / name).string();
+    }
+
+    // Таблица из снимка, если он есть, цел и соответствует источнику. Проверяется
+    // только заголовок и границы массивов, отдельные ячейки — при обращении к ним.
+    static std::optional<MappedTable> load(const std::string& snapshotPath, const SourceStamp& stamp) {
+        std::error_code error;
+        if (!std::filesystem::exists(snapshotPath, error)) {
+            return std::nullopt;
+        }
+
+        MappedFile file(snapshotPath);
+        const std::string_view bytes = file.view();
+        Header header;
+        if (bytes.size() < sizeof(header)) {
+            return std::nullopt;
+        }
+        std::memcpy(&header, bytes.data(), sizeof(header));
+        if (std::memcmp(header.magic, kMagic, sizeof(header.magic)) != 0 || header.byteOrder != kByteOrder ||
+            !(header.source == stamp)) {
+            return std::nullopt;
+        }
+        if (header.rowCount > bytes.size() || header.cellCount > bytes.size() || header.heapSize > bytes.size() ||
+            sizeof(header) + (header.rowCount + 1 + header.cellCount) * sizeof(uint64_t) + header.heapSize != bytes.size()) {
+            return std::nullopt;
+        }
+
+        MappedTable::SnapshotIndex index;
+        index.rows = reinterpret_cast<const uint64_t*>(bytes.data() + sizeof(header));
+        index.cellEnds = index.rows + header.rowCount + 1;
+        index.heap = reinterpret_cast<const char*>(index.cellEnds + header.cellCount);
+        index.rowCount = static_cast<size_t>(header.rowCount);
+        index.cellCount = static_cast<size_t>(header.cellCount);
+        index.heapSize = static_cast<size_t>(header.heapSize);
+        if (index.rows[0] != 0 || index.rows[index.rowCount] != header.cellCount ||
+            (index.cellCount > 0 && index.cellEnds[index.cellCount - 1] != header.heapSize)) {
+            return std::nullopt;
+        }
+        return MappedTable::fromSnapshot(std::move(file), index);
+    }
+
+    // Запись через временный файл и переименование: читатели видят только целый снимок
+    static void save(const std::string& snapshotPath, const SourceStamp& stamp, const MappedTable& table) {
+        Header header{};
+        std::memcpy(header.magic, kMagic, sizeof(header.magic));
+        header.byteOrder = kByteOrder;
+        header.source = stamp;
+        header.rowCount = table.rowCount();
+
+        std::vector<uint64_t> rowOffsets;
+        rowOffsets.reserve(table.rowCount() + 1);
+        rowOffsets.push_back(0);
+        std::vector<uint64_t> cellEnds;
+        for (size_t row = 0; row < table.rowCount(); ++row) {
+            for (size_t column = 0; column < table.cellCount(row); ++column) {
+                header.heapSize += table.cell(row, column).size();
+                cellEnds.push_back(header.heapSize);
+            }
+            rowOffsets.push_back(cellEnds.size());
+        }
+        header.cellCount = cellEnds.size();
+
+        const std::string temporary = snapshotPath + ".tmp";
+        {
+            std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            file.write(reinterpret_cast<const char*>(rowOffsets.data()), rowOffsets.size() * sizeof(uint64_t));
+            file.write(reinterpret_cast<const char*>(cellEnds.data()), cellEnds.size() * sizeof(uint64_t));
+            for (size_t row = 0; row < table.rowCount(); ++row) {
+                for (size_t column = 0; column < table.cellCount(row); ++column) {
+                    const std::string_view cell = table.cell(row, column);
+                    file.write(cell.data(), cell.size());
+                }
+            }
+            if (!file.flush()) {
+                throw std::runtime_error("Failed to write snapshot: " + snapshotPath);
+            }
+        }
+
+        std::error_code error;
+        std::filesystem::rename(temporary, snapshotPath, error);
+        if (error) {
+            std::filesystem::remove(temporary, error);
+            throw std::runtime_error("Failed to write snapshot: " + snapshotPath);
+        }
+    }
+
+private:
+    static constexpr char kMagic[8] = { 'T', 'B', 'L', 'S', 'N', 'A', 'P', '1' };
+    static constexpr uint64_t kByteOrder = 0x0102030405060708ull;
+
+    struct Header {
+        char magic[8];
+        uint64_t byteOrder;
+        SourceStamp source;
+        uint64_t rowCount;
+        uint64_t cellCount;
+        uint64_t heapSize;
+    };
+};
 
 class DataReader {
+protected:
+    // Разбирает полные записи, начиная с offset, и возвращает смещение после последней из них;
+    // незавершённая запись в конце не разбирается.
+    virtual size_t parseAppended(std::string_view text, size_t offset, MappedTable& table, ReadCheckpoint& checkpoint) = 0;
+
+    // Имя формата для ключа снимка: один файл, прочитанный разными читателями, даёт разные снимки
+    virtual std::string formatName() const = 0;
+
+public:
+    virtual ~DataReader() = default;
+
+    // Копирующий режим: ячейки становятся владеющими строками.
+    virtual std::vector<std::vector<std::string>> readData(const std::string& filename) {
+        return readMapped(filename).toStrings();
+    }
+
+    // Режим без копирования: файл открывается один раз и отображается в память.
+    virtual MappedTable readMapped(const std::string& filename) = 0;
+
+    // Столбцовый режим: типы столбцов определяются по данным.
+    ColumnarTable readColumnar(const std::string& filename) {
+        return ColumnarTable::fromMapped(readMapped(filename));
+    }
+
+    // Режим дозаписи: возвращает только полные записи, появившиеся после checkpoint,
+    // и сдвигает его; стоимость зависит от объёма новых данных, а не от размера файла.
+    // При усечении, ротации (по пути лежит другой файл) или перезаписи начала файла
+    // чтение начинается заново с нуля.
+    MappedTable readAppended(const std::string& filename, ReadCheckpoint& checkpoint) {
+        MappedTable table{ MappedFile(filename) };
+        const std::string_view text = table.text();
+        const MappedFile::Identity identity = table.file().getIdentity();
+
+        if (!checkpoint.matches(identity, text)) {
+            checkpoint = ReadCheckpoint();
+            checkpoint.device = identity.device;
+            checkpoint.fileIndex = identity.index;
+        }
+        checkpoint.fromStart = checkpoint.offset == 0;
+
+        checkpoint.offset = parseAppended(text, static_cast<size_t>(checkpoint.offset), table, checkpoint);
+        if (checkpoint.signatureLength < ReadCheckpoint::kSignatureBytes) {
+            checkpoint.signatureLength = std::min<uint64_t>(checkpoint.offset, ReadCheckpoint::kSignatureBytes);
+            checkpoint.signature = ReadCheckpoint::hashPrefix(text, static_cast<size_t>(checkpoint.signatureLength));
+        }
+        return table;
+    }
+
+    // То же с контрольной точкой в файле: она сохраняется перед возвратом строк
+    MappedTable readAppended(const std::string& filename, const std::string& checkpointPath) {
+        ReadCheckpoint checkpoint = ReadCheckpoint::load(checkpointPath);
+        MappedTable table = readAppended(filename, checkpoint);
+        checkpoint.save(checkpointPath);
+        return table;
+    }
+
+    // Чтение через снимок в cacheDirectory: если размер и время изменения источника
+    // совпадают с записанными в снимке, таблица отображается из него без разбора текста;
+    // иначе файл разбирается заново и снимок перезаписывается. Ячейки указывают в снимок.
+    MappedTable readCached(const std::string& filename, const std::string& cacheDirectory) {
+        const TableSnapshot::SourceStamp stamp = TableSnapshot::SourceStamp::of(filename, formatName());
+        const std::string snapshotPath = TableSnapshot::pathFor(cacheDirectory, stamp);
+        if (std::optional<MappedTable> cached = TableSnapshot::load(snapshotPath, stamp)) {
+            return std::move(*cached);
+        }
+
+        MappedTable table = readMapped(filename);
+        // Файл мог измениться во время разбора: такой снимок не сохраняется
+        if (TableSnapshot::SourceStamp::of(filename, formatName()) == stamp) {
+            std::filesystem::create_directories(cacheDirectory);
+            TableSnapshot::save(snapshotPath, stamp, table);
+        }
+        return table;
+    }
+};
+
+class CSVReader : public DataReader {
+protected:
+    StructuralScanner scanner{ ',' };
+
+    // Разбирает фрагмент текста по RFC 4180 и дописывает строки в таблицу.
+    void parseRange(std::string_view text, MappedTable& table) const {
+        scanner.tokenizeQuoted(text,
+            [&](std::string_view cell, bool escaped) {
+                table.addCell(escaped ? table.storeUnescaped(cell) : cell);
+            },
+            [&]() {
+                if (!table.empty() && table.pendingCells() != table.cellCount(0)) {
+                    throw std::runtime_error("Invalid CSV format: inconsistent number of columns");
+                }
+                table.endRow();
+                return true;
+            });
+    }
+
+    size_t parseAppended(std::string_view text, size_t offset, MappedTable& table, ReadCheckpoint& checkpoint) override {
+        // Конец последней полной записи — последний перевод строки вне кавычек;
+        // offset всегда стоит на границе записи, так что чётность кавычек считается от него.
+        size_t quotes = std::count(text.begin() + offset, text.end(), '"');
+        size_t end = text.size();
+        while (true) {
+            const size_t newline = end > offset ? text.rfind('\n', end - 1) : std::string_view::npos;
+            if (newline == std::string_view::npos || newline < offset) {
+                return offset;
+            }
+            quotes -= std::count(text.begin() + newline, text.begin() + end, '"');
+            if (quotes % 2 == 0) {
+                end = newline + 1;
+                break;
+            }
+            end = newline;
+        }
+
+        parseRange(text.substr(offset, end - offset), table);
+        if (!table.empty()) {
+            if (checkpoint.columns == 0) {
+                checkpoint.columns = table.cellCount(0);
+            }
+            else if (table.cellCount(0) != checkpoint.columns) {
+                throw std::runtime_error("Invalid CSV format: inconsistent number of columns");
+            }
+        }
+        return end;
+    }
+
+    std::string formatName() const override {
+        return "csv";
+    }
+
+public:
+    MappedTable readMapped(const std::string& filename) override {
+        MappedTable table{ MappedFile(filename) };
+        parseRange(table.text(), table);
+
+        if (table.empty()) {
+            throw std::runtime_error("Empty CSV file");
+        }
+
+        return table;
+    }
+};
+
+// Параллельное чтение CSV: файл делится на фрагменты по числу потоков,
+// границы сдвигаются к ближайшему переводу строки вне кавычек, фрагменты
+// разбираются одновременно и склеиваются в исходном порядке.
+class ParallelCSVReader : public CSVReader {
+private:
+    unsigned threadCount;
+
+    static constexpr size_t kMinChunkSize = 1024 * 1024;
+
+    template <typename Task>
+    void runParallel(size_t count, Task&& task) const {
+        std::vector<std::exception_ptr> errors(count);
+        std::vector<std::thread> workers;
+        workers.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            workers.emplace_back([&, i]() {
+                try {
+                    task(i);
+                }
+                catch (...) {
+                    errors[i] = std::current_exception();
+                }
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        for (auto& error : errors) {
+            if (error) {
+                std::rethrow_exception(error);
+            }
+        }
+    }
+
+public:
+    explicit ParallelCSVReader(unsigned threads = std::thread::hardware_concurrency())
+        : threadCount(threads == 0 ? 1 : threads) {}
+
+    MappedTable readMapped(const std::string& filename) override {
+        MappedTable table{ MappedFile(filename) };
+        std::string_view text = table.text();
+        const size_t chunkCount = std::max<size_t>(1, std::min<size_t>(threadCount, text.size() / kMinChunkSize));
+
+        if (chunkCount == 1) {
+            parseRange(text, table);
+        }
+        else {
+            // Чётность числа кавычек перед началом фрагмента показывает,
+            // начинается ли он внутри поля в кавычках.
+            std::vector<size_t> nominal(chunkCount + 1);
+            for (size_t i = 0; i <= chunkCount; ++i) {
+                nominal[i] = text.size() / chunkCount * i;
+            }
+            nominal[chunkCount] = text.size();
+
+            std::vector<size_t> quoteCounts(chunkCount);
+            runParallel(chunkCount, [&](size_t i) {
+                quoteCounts[i] = std::count(text.begin() + nominal[i], text.begin() + nominal[i + 1], '"');
+            });
+
+            std::vector<size_t> boundaries(chunkCount + 1, text.size());
+            boundaries[0] = 0;
+            size_t quotesBefore = 0;
+            for (size_t i = 1; i < chunkCount; ++i) {
+                quotesBefore += quoteCounts[i - 1];
+                bool inQuotes = quotesBefore % 2 != 0;
+                size_t pos = nominal[i];
+                while (pos < text.size() && (inQuotes || text[pos] != '\n')) {
+                    if (text[pos] == '"') {
+                        inQuotes = !inQuotes;
+                    }
+                    ++pos;
+                }
+                boundaries[i] = std::max(boundaries[i - 1], std::min(pos + 1, text.size()));
+            }
+
+            std::vector<MappedTable> parts;
+            parts.reserve(chunkCount);
+            for (size_t i = 0; i < chunkCount; ++i) {
+                parts.emplace_back(MappedFile());
+            }
+
+            runParallel(chunkCount, [&](size_t i) {
+                parseRange(text.substr(boundaries[i], boundaries[i + 1] - boundaries[i]), parts[i]);
+            });
+
+            for (auto& part : parts) {
+                if (!table.empty() && !part.empty() && part.cellCount(0) != table.cellCount(0)) {
+                    throw std::runtime_error("Invalid CSV format: inconsistent number of columns");
+                }
+                table.append(std::move(part));
+            }
+        }
+
+        if (table.empty()) {
+            throw std::runtime_error("Empty CSV file");
+        }
+
+        return table;
+    }
+};
+
+// Привязка столбца CSV к члену структуры: имя в заголовке и указатель на член.
+template <typename Row, typename Field>
+struct ColumnBinding {
+    std::string_view header;
+    Field Row::* member;
+};
+
+template <typename Row, typename Field>
+constexpr ColumnBinding<Row, Field> bindColumn(std::string_view header, Field Row::* member) {
+    return { header, member };
+}
+
+// Схема строки задаётся специализацией для конкретной структуры:
+//   template <> struct CsvSchema<Person> {
+//       static constexpr auto columns = std::make_tuple(bindColumn("Name", &Person::name), ...);
+//   };
+template <typename Row>
+struct CsvSchema;
+
+// Преобразование текста ячейки в значение поля без промежуточных строк:
+// числа разбираются std::from_chars целиком, bool принимает true/false/1/0.
+template <typename T>
+bool parseCsvField(std::string_view text, T& value) {
+    if constexpr (std::is_same_v<T, bool>) {
+        if (text == "true" || text == "1") value = true;
+        else if (text == "false" || text == "0") value = false;
+        else return false;
+        return true;
+    }
+    else if constexpr (std::is_arithmetic_v<T>) {
+        auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+        return result.ec == std::errc() && result.ptr == text.data() + text.size();
+    }
+    else if constexpr (std::is_same_v<T, std::string>) {
+        value.assign(text.data(), text.size());
+        return true;
+    }
+    else {
+        static_assert(sizeof(T) == 0, "Unsupported CSV field type");
+    }
+}
+
+// Пустая ячейка для необязательного поля — std::nullopt
+template <typename T>
+bool parseCsvField(std::string_view text, std::optional<T>& value) {
+    if (text.empty()) {
+        value.reset();
+        return true;
+    }
+    T parsed{};
+    if (!parseCsvField(text, parsed)) {
+        return false;
+    }
+    value = std::move(parsed);
+    return true;
+}
+
+// Чтение CSV сразу в структуры: соответствие столбцов членам Row описано в CsvSchema<Row>
+// на этапе компиляции. Заголовок сверяется со схемой один раз — все отсутствующие столбцы
+// перечисляются в одном исключении, лишние столбцы пропускаются, порядок столбцов
+// в файле может быть любым. Ячейки преобразуются прямо из отображения файла.
+template <typename Row>
+class TypedCsvReader {
 public:
-    virtual ~DataReader() = default;
+    explicit TypedCsvReader(char delimiter = ',') : scanner(delimiter) {}
+
+    // Вызывает onRow(Row&&) для каждой записи без накопления; возвращает число записей.
+    template <typename OnRow>
+    size_t forEach(const std::string& filename, OnRow&& onRow) const {
+        static const std::array<Setter, kFieldCount> setters = makeSetters(std::make_index_sequence<kFieldCount>());
+
+        MappedFile file(filename);
+        std::vector<std::string> headerNames;
+        std::vector<int> fieldForColumn;
+        std::string scratch;
+        Row row{};
+        size_t column = 0;
+        size_t records = 0;
+        bool inHeader = true;
+
+        scanner.tokenizeQuoted(file.view(),
+            [&](std::string_view cell, bool escaped) {
+                if (escaped) {
+                    scratch.clear();
+                    for (size_t i = 0; i < cell.size(); ++i) {
+                        scratch.push_back(cell[i]);
+                        if (cell[i] == '"' && i + 1 < cell.size() && cell[i + 1] == '"') {
+                            ++i;
+                        }
+                    }
+                    cell = scratch;
+                }
+
+                if (inHeader) {
+                    headerNames.emplace_back(cell);
+                }
+                else if (column < fieldForColumn.size() && fieldForColumn[column] >= 0) {
+                    const int field = fieldForColumn[column];
+                    if (!setters[field](row, cell)) {
+                        throw std::runtime_error("Invalid CSV value '" + std::string(cell) + "' for column '" +
+                            std::string(headers()[field]) + "' in record " + std::to_string(records + 1));
+                    }
+                }
+                ++column;
+            },
+            [&]() {
+                if (inHeader) {
+                    fieldForColumn = resolveHeader(headerNames);
+                    inHeader = false;
+                }
+                else {
+                    if (column != fieldForColumn.size()) {
+                        throw std::runtime_error("Invalid CSV format: inconsistent number of columns");
+                    }
+                    onRow(std::move(row));
+                    row = Row{};
+                    ++records;
+                }
+                column = 0;
+                return true;
+            });
+
+        if (inHeader) {
+            throw std::runtime_error("Empty CSV file");
+        }
+
+        return records;
+    }
+
+    std::vector<Row> read(const std::string& filename) const {
+        std::vector<Row> rows;
+        forEach(filename, [&](Row&& row) {
+            rows.push_back(std::move(row));
+        });
+        return rows;
+    }
+
+private:
+    using Columns = std::decay_t<decltype(CsvSchema<Row>::columns)>;
+    using Setter = bool (*)(Row&, std::string_view);
+
+    static constexpr size_t kFieldCount = std::tuple_size_v<Columns>;
+
+    StructuralScanner scanner;
+
+    template <size_t... I>
+    static std::array<std::string_view, kFieldCount> makeHeaders(std::index_sequence<I...>) {
+        return { { std::get<I>(CsvSchema<Row>::columns).header... } };
+    }
+
+    static const std::array<std::string_view, kFieldCount>& headers() {
+        static const std::array<std::string_view, kFieldCount> names = makeHeaders(std::make_index_sequence<kFieldCount>());
+        return names;
+    }
+
+    // Для каждого поля схемы — функция, разбирающая ячейку прямо в член структуры
+    template <size_t I>
+    static bool setField(Row& row, std::string_view text) {
+        return parseCsvField(text, row.*(std::get<I>(CsvSchema<Row>::columns).member));
+    }
+
+    template <size_t... I>
+    static std::array<Setter, kFieldCount> makeSetters(std::index_sequence<I...>) {
+        return { { &setField<I>... } };
+    }
+
+    // Номер поля схемы для каждого столбца файла (-1 — столбец не нужен).
+    static std::vector<int> resolveHeader(const std::vector<std::string>& headerNames) {
+        std::vector<int> fieldForColumn(headerNames.size(), -1);
+        std::string missing;
+        for (size_t field = 0; field < kFieldCount; ++field) {
+            auto found = std::find(headerNames.begin(), headerNames.end(), headers()[field]);
+            if (found == headerNames.end()) {
+                missing += (missing.empty() ? "" : ", ") + std::string(headers()[field]);
+                continue;
+            }
+            fieldForColumn[found - headerNames.begin()] = static_cast<int>(field);
+        }
+        if (!missing.empty()) {
+            throw std::runtime_error("CSV header does not match schema, missing columns: " + missing);
+        }
+        return fieldForColumn;
+    }
+};
+
+// Потоковый (push) разбор XML-таблицы из <row> и <cell>: данные подаются через feed()
+// кусками любого размера (файл, pipe, буфер сокета), раскладка пробелов и переводов
+// строк не важна. Каждая строка передаётся в onRow, как только закрывается </row>;
+// память ограничена одной строкой таблицы. Ячейки, целиком лежащие в текущем куске
+// и не содержащие сущностей, передаются как string_view в этот кусок без копирования.
+class XmlRowParser {
+public:
+    using RowCallback = std::function<void(const std::vector<std::string_view>& cells)>;
+
+    static constexpr size_t kMaxNameLength = 256;
+    static constexpr size_t kMaxEntityLength = 16;
+
+    explicit XmlRowParser(RowCallback callback) : onRow(std::move(callback)) {}
+
+    void feed(std::string_view chunk) {
+        const char* data = chunk.data();
+        const size_t size = chunk.size();
+        segmentStart = 0;
+
+        for (size_t i = 0; i < size; ++i) {
+            const char c = data[i];
+            switch (state) {
+            case State::Text:
+                if (inCell) {
+                    while (i < size && data[i] != '<' && data[i] != '&') {
+                        ++i;
+                    }
+                    if (i == size) {
+                        break;
+                    }
+                    appendSegment(chunk, i);
+                    if (data[i] == '&') {
+                        ownCell();
+                        entity.clear();
+                        state = State::Entity;
+                        break;
+                    }
+                }
+                else {
+                    while (i < size && data[i] != '<') {
+                        ++i;
+                    }
+                    if (i == size) {
+                        break;
+                    }
+                }
+                state = State::TagStart;
+                break;
+
+            case State::Entity:
+                if (c == ';') {
+                    decodeEntity();
+                    toText(i);
+                }
+                else if (entity.size() >= kMaxEntityLength) {
+                    fail("unterminated entity");
+                }
+                else {
+                    entity.push_back(c);
+                }
+                break;
+
+            case State::TagStart:
+                if (c != '!' && c != '?') {
+                    if (size_t length = parseWholeTag(data + i, size - i)) {
+                        i += length - 1;
+                        endTag(i);
+                        break;
+                    }
+                }
+                tagName.clear();
+                closing = false;
+                selfClosing = false;
+                if (c == '/') {
+                    closing = true;
+                    state = State::Name;
+                }
+                else if (c == '!') {
+                    state = State::Bang;
+                }
+                else if (c == '?') {
+                    resetTail();
+                    state = State::Instruction;
+                }
+                else if (isNameChar(c)) {
+                    tagName.push_back(c);
+                    state = State::Name;
+                }
+                else {
+                    fail("malformed tag");
+                }
+                break;
+
+            case State::Name: {
+                size_t end = i;
+                while (end < size && isNameChar(data[end])) {
+                    ++end;
+                }
+                if (tagName.size() + (end - i) > kMaxNameLength) {
+                    fail("tag name too long");
+                }
+                tagName.append(data + i, end - i);
+                i = end;
+                if (i == size) {
+                    break;
+                }
+                if (tagName.empty()) {
+                    fail("malformed tag");
+                }
+                const char delimiter = data[i];
+                if (delimiter == '>') {
+                    tagView = tagName;
+                    endTag(i);
+                }
+                else if (delimiter == '/' || isSpace(delimiter)) {
+                    selfClosing = delimiter == '/';
+                    state = State::InTag;
+                }
+                else {
+                    fail("malformed tag");
+                }
+                break;
+            }
+
+            case State::InTag:
+                if (c == '>') {
+                    tagView = tagName;
+                    endTag(i);
+                }
+                else if (closing && !isSpace(c)) {
+                    fail("malformed closing tag");
+                }
+                else if (c == '/') {
+                    selfClosing = true;
+                }
+                else if (c == '"' || c == '\'') {
+                    quote = c;
+                    state = State::AttributeValue;
+                }
+                else if (!isSpace(c)) {
+                    selfClosing = false;
+                }
+                break;
+
+            case State::AttributeValue:
+                if (c == quote) {
+                    state = State::InTag;
+                }
+                break;
+
+            case State::Bang:
+                tagName.push_back(c);
+                if (tagName == "--") {
+                    resetTail();
+                    state = State::Comment;
+                }
+                else if (tagName == "[CDATA[") {
+                    if (inCell) {
+                        ownCell();
+                    }
+                    resetTail();
+                    state = State::CData;
+                }
+                else if (std::string_view("--").compare(0, tagName.size(), tagName) != 0 &&
+                    std::string_view("[CDATA[").compare(0, tagName.size(), tagName) != 0) {
+                    state = c == '>' ? State::Text : State::Declaration;
+                    segmentStart = i + 1;
+                }
+                break;
+
+            case State::Comment:
+                pushTail(c);
+                if (tailEndsWith("-->")) {
+                    toText(i);
+                }
+                break;
+
+            case State::CData:
+                pushTail(c);
+                if (inCell) {
+                    rowStorage.push_back(c);
+                }
+                if (tailEndsWith("]]>")) {
+                    if (inCell) {
+                        rowStorage.resize(rowStorage.size() - 3);
+                    }
+                    toText(i);
+                }
+                break;
+
+            case State::Instruction:
+                pushTail(c);
+                if (tailEndsWith("?>")) {
+                    toText(i);
+                }
+                break;
+
+            case State::Declaration:
+                if (c == '>') {
+                    toText(i);
+                }
+                break;
+            }
+        }
+        fedBytes += size;
+
+        // Ссылки в кусок после возврата недействительны: незавершённая строка копируется
+        if (inCell) {
+            if (state == State::Text) {
+                appendSegment(chunk, size);
+            }
+            ownCell();
+        }
+        else {
+            materializeCells();
+        }
+    }
+
+    // Конец данных: проверяет, что документ и последняя строка закрыты.
+    void finish() {
+        if (state != State::Text) {
+            fail("unexpected end of document");
+        }
+        if (inCell) {
+            fail("unclosed <cell>");
+        }
+        if (inRow) {
+            fail("unclosed <row>");
+        }
+    }
+
+    size_t rowCount() const {
+        return rows;
+    }
+
+    // Смещение от начала поданных данных сразу после последней завершённой строки
+    size_t completedBytes() const {
+        return rowsEnd;
+    }
+
+private:
+    enum class State {
+        Text,
+        Entity,
+        TagStart,
+        Name,
+        InTag,
+        AttributeValue,
+        Bang,
+        Comment,
+        CData,
+        Instruction,
+        Declaration
+    };
+
+    // Ячейка текущей строки: view в текущий кусок или диапазон в rowStorage
+    struct CellRef {
+        const char* data;
+        size_t offset;
+        size_t size;
+    };
+
+    RowCallback onRow;
+    State state = State::Text;
+    std::string tagName;
+    std::string_view tagView;
+    std::string entity;
+    bool closing = false;
+    bool selfClosing = false;
+    char quote = '"';
+    char tail[3] = {};
+
+    bool inRow = false;
+    bool inCell = false;
+    bool cellOwned = false;
+    std::string_view cellView;
+    size_t cellOffset = 0;
+    size_t segmentStart = 0;
+
+    std::vector<CellRef> cells;
+    std::string rowStorage;
+    std::vector<std::string_view> rowViews;
+    size_t rows = 0;
+    size_t fedBytes = 0;
+    size_t rowsEnd = 0;
+
+    [[noreturn]] void fail(const char* message) const {
+        throw std::runtime_error(std::string("Invalid XML format: ") + message);
+    }
+
+    static bool isSpace(char c) {
+        return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+    }
+
+    static bool isNameChar(char c) {
+        return !isSpace(c) && c != '<' && c != '>' && c != '/' && c != '=' && c != '"' && c != '\'';
+    }
+
+    // Быстрый путь: тег без кавычек, целиком лежащий в куске, разбирается сразу.
+    // Возвращает длину тега после '<' вместе с '>' или 0 для посимвольного разбора.
+    size_t parseWholeTag(const char* text, size_t available) {
+        size_t end = 0;
+        while (end < available && text[end] != '>' && text[end] != '"' && text[end] != '\'') {
+            ++end;
+        }
+        if (end == available || text[end] != '>') {
+            return 0;
+        }
+
+        std::string_view tag(text, end);
+        closing = !tag.empty() && tag[0] == '/';
+        if (closing) {
+            tag.remove_prefix(1);
+        }
+        selfClosing = !closing && !tag.empty() && tag.back() == '/';
+        if (selfClosing) {
+            tag.remove_suffix(1);
+        }
+
+        size_t nameEnd = 0;
+        while (nameEnd < tag.size() && isNameChar(tag[nameEnd])) {
+            ++nameEnd;
+        }
+        if (nameEnd == 0 || nameEnd > kMaxNameLength || (nameEnd < tag.size() && !isSpace(tag[nameEnd]))) {
+            fail("malformed tag");
+        }
+        if (closing && tag.find_first_not_of(" \t\r\n", nameEnd) != std::string_view::npos) {
+            fail("malformed closing tag");
+        }
+        tagView = tag.substr(0, nameEnd);
+        return end + 1;
+    }
+
+    void resetTail() {
+        tail[0] = tail[1] = tail[2] = 0;
+    }
+
+    void pushTail(char c) {
+        tail[0] = tail[1];
+        tail[1] = tail[2];
+        tail[2] = c;
+    }
+
+    bool tailEndsWith(std::string_view terminator) const {
+        return std::string_view(tail + 3 - terminator.size(), terminator.size()) == terminator;
+    }
+
+    void toText(size_t i) {
+        state = State::Text;
+        segmentStart = i + 1;
+    }
+
+    void appendSegment(std::string_view chunk, size_t end) {
+        std::string_view segment = chunk.substr(segmentStart, end - segmentStart);
+        if (cellOwned) {
+            rowStorage.append(segment);
+        }
+        else if (cellView.empty()) {
+            cellView = segment;
+        }
+        else {
+            ownCell();
+            rowStorage.append(segment);
+        }
+    }
+
+    // Переводит текущую ячейку в rowStorage; предыдущие ячейки копируются раньше,
+    // чтобы текст ячейки оставался непрерывным.
+    void ownCell() {
+        if (cellOwned) {
+            return;
+        }
+        materializeCells();
+        cellOffset = rowStorage.size();
+        rowStorage.append(cellView);
+        cellView = {};
+        cellOwned = true;
+    }
+
+    void materializeCells() {
+        for (CellRef& cell : cells) {
+            if (cell.data != nullptr) {
+                cell.offset = rowStorage.size();
+                rowStorage.append(cell.data, cell.size);
+                cell.data = nullptr;
+            }
+        }
+    }
+
+    void decodeEntity() {
+        if (entity == "lt") rowStorage.push_back('<');
+        else if (entity == "gt") rowStorage.push_back('>');
+        else if (entity == "amp") rowStorage.push_back('&');
+        else if (entity == "quot") rowStorage.push_back('"');
+        else if (entity == "apos") rowStorage.push_back('\'');
+        else if (entity.size() > 1 && entity[0] == '#') {
+            const bool hex = entity[1] == 'x';
+            uint32_t codePoint = 0;
+            const char* first = entity.data() + (hex ? 2 : 1);
+            const char* last = entity.data() + entity.size();
+            auto [end, error] = std::from_chars(first, last, codePoint, hex ? 16 : 10);
+            if (error != std::errc() || end != last || first == last || codePoint > 0x10FFFF) {
+                fail("invalid character reference");
+            }
+            appendUtf8(codePoint);
+        }
+        else {
+            fail("unknown entity");
+        }
+    }
+
+    void appendUtf8(uint32_t codePoint) {
+        if (codePoint < 0x80) {
+            rowStorage.push_back(static_cast<char>(codePoint));
+        }
+        else if (codePoint < 0x800) {
+            rowStorage.push_back(static_cast<char>(0xC0 | (codePoint >> 6)));
+            rowStorage.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+        }
+        else if (codePoint < 0x10000) {
+            rowStorage.push_back(static_cast<char>(0xE0 | (codePoint >> 12)));
+            rowStorage.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+            rowStorage.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+        }
+        else {
+            rowStorage.push_back(static_cast<char>(0xF0 | (codePoint >> 18)));
+            rowStorage.push_back(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F)));
+            rowStorage.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+            rowStorage.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+        }
+    }
+
+    void endTag(size_t i) {
+        toText(i);
+
+        if (tagView == "row") {
+            if (closing) {
+                if (!inRow) {
+                    fail("closing </row> without opening");
+                }
+                if (inCell) {
+                    fail("unclosed <cell>");
+                }
+                emitRow();
+                rowsEnd = fedBytes + i + 1;
+            }
+            else {
+                if (inCell) {
+                    fail("unexpected element inside <cell>");
+                }
+                if (inRow) {
+                    fail("nested <row> tags");
+                }
+                inRow = true;
+                if (selfClosing) {
+                    emitRow();
+                    rowsEnd = fedBytes + i + 1;
+                }
+            }
+        }
+        else if (tagView == "cell") {
+            if (closing) {
+                if (!inCell) {
+                    fail("closing </cell> without opening");
+                }
+                finishCell();
+            }
+            else {
+                if (!inRow) {
+                    fail("<cell> outside <row>");
+                }
+                if (inCell) {
+                    fail("nested <cell> tags");
+                }
+                inCell = true;
+                cellOwned = false;
+                cellView = {};
+                if (selfClosing) {
+                    finishCell();
+                }
+            }
+        }
+        else if (inCell) {
+            fail("unexpected element inside <cell>");
+        }
+    }
+
+    void finishCell() {
+        if (cellOwned) {
+            cells.push_back(CellRef{ nullptr, cellOffset, rowStorage.size() - cellOffset });
+        }
+        else {
+            cells.push_back(CellRef{ cellView.data(), 0, cellView.size() });
+        }
+        inCell = false;
+        cellOwned = false;
+        cellView = {};
+    }
+
+    void emitRow() {
+        rowViews.clear();
+        for (const CellRef& cell : cells) {
+            rowViews.emplace_back(cell.data != nullptr ? cell.data : rowStorage.data() + cell.offset, cell.size);
+        }
+        onRow(rowViews);
+        ++rows;
+        inRow = false;
+        cells.clear();
+        rowStorage.clear();
+    }
+};
+
+class XMLReader : public DataReader {
+protected:
+    // Парсер, дописывающий строки в таблицу: ячейки из отображения файла берутся
+    // без копирования, раскодированные копируются в таблицу.
+    static XmlRowParser tableParser(MappedTable& table) {
+        return XmlRowParser([&table](const std::vector<std::string_view>& cells) {
+            const std::string_view text = table.text();
+            for (std::string_view cell : cells) {
+                const bool inFile = cell.data() >= text.data() && cell.data() + cell.size() <= text.data() + text.size();
+                table.addCell(inFile ? cell : table.storeCopy(cell));
+            }
+            table.endRow();
+        });
+    }
+
+    size_t parseAppended(std::string_view text, size_t offset, MappedTable& table, ReadCheckpoint&) override {
+        XmlRowParser parser = tableParser(table);
+        parser.feed(text.substr(offset));
+        return offset + parser.completedBytes();
+    }
+
+    std::string formatName() const override {
+        return "xml";
+    }
+
+public:
+    static constexpr size_t kStreamBlockSize = 64 * 1024;
+
+    MappedTable readMapped(const std::string& filename) override {
+        MappedTable table{ MappedFile(filename) };
+        XmlRowParser parser = tableParser(table);
+        parser.feed(table.text());
+        parser.finish();
+
+        if (table.empty()) {
+            throw std::runtime_error("Empty XML file");
+        }
+
+        return table;
+    }
+
+    // Потоковое чтение из istream (файл, pipe, сокет) блоками kStreamBlockSize;
+    // ячейки действительны только внутри onRow. Возвращает число строк.
+    size_t readStream(std::istream& input, const XmlRowParser::RowCallback& onRow) const {
+        XmlRowParser parser(onRow);
+        std::vector<char> buffer(kStreamBlockSize);
+        while (input.read(buffer.data(), buffer.size()) || input.gcount() > 0) {
+            parser.feed(std::string_view(buffer.data(), static_cast<size_t>(input.gcount())));
+        }
+        if (input.bad()) {
+            throw std::runtime_error("Error reading XML stream");
+        }
+        parser.finish();
+        return parser.rowCount();
+    }
+};
+
+enum class TableFormat {
+    Csv,
+    Ndjson,
+    Xml
+};
+
+// Буферизованная запись таблицы в CSV (кавычки по RFC 4180), NDJSON или XML в формате
+// XMLReader (<table><row><cell>). Строки собираются в буфер и сбрасываются блоками
+// по kBufferSize байт прямо в файловый дескриптор или в ostream. Ячейки без специальных
+// символов копируются целиком, экранируются только ячейки, где они встречаются.
+// Для NDJSON при headerRow первая строка задаёт имена полей объектов, иначе строки
+// пишутся массивами.
+class TableWriter {
+public:
+    static constexpr size_t kBufferSize = 1024 * 1024;
+
+    // Запись в открытый дескриптор; владение им не передаётся
+    TableWriter(int fileDescriptor, TableFormat tableFormat, bool headerRow = false)
+        : fd(fileDescriptor), format(tableFormat), hasHeader(headerRow) {
+        begin();
+    }
+
+    TableWriter(std::ostream& output, TableFormat tableFormat, bool headerRow = false)
+        : stream(&output), format(tableFormat), hasHeader(headerRow) {
+        begin();
+    }
+
+    TableWriter(const std::string& filename, TableFormat tableFormat, bool headerRow = false)
+        : format(tableFormat), hasHeader(headerRow) {
+#if defined(_WIN32)
+        fd = _open(filename.c_str(), _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+        fd = ::open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+#endif
+        if (fd < 0) {
+            throw std::runtime_error("Failed to create file: " + filename);
+        }
+        ownsDescriptor = true;
+        begin();
+    }
+
+    TableWriter(const TableWriter&) = delete;
+    TableWriter& operator=(const TableWriter&) = delete;
+
+    ~TableWriter() {
+        try {
+            finish();
+        }
+        catch (...) {
+        }
+        if (ownsDescriptor) {
+#if defined(_WIN32)
+            _close(fd);
+#else
+            ::close(fd);
+#endif
+        }
+    }
+
+    template <typename Cells>
+    void writeRow(const Cells& cells) {
+        if (hasHeader && format == TableFormat::Ndjson && fieldNames.empty()) {
+            for (const auto& cell : cells) {
+                fieldNames.emplace_back(cell);
+            }
+            return;
+        }
+
+        size_t column = 0;
+        switch (format) {
+        case TableFormat::Csv:
+            for (const auto& cell : cells) {
+                if (column++ > 0) {
+                    buffer.push_back(',');
+                }
+                appendCsv(cell);
+            }
+            buffer.push_back('\n');
+            break;
+        case TableFormat::Ndjson:
+            buffer.push_back(fieldNames.empty() ? '[' : '{');
+            for (const auto& cell : cells) {
+                if (column > 0) {
+                    buffer.push_back(',');
+                }
+                if (!fieldNames.empty()) {
+                    if (column >= fieldNames.size()) {
+                        throw std::runtime_error("Row has more cells than header fields");
+                    }
+                    appendJson(fieldNames[column]);
+                    buffer.push_back(':');
+                }
+                appendJson(cell);
+                ++column;
+            }
+            buffer.append(fieldNames.empty() ? "]\n" : "}\n");
+            break;
+        case TableFormat::Xml:
+            buffer.append("<row>");
+            for (const auto& cell : cells) {
+                buffer.append("<cell>");
+                appendXml(cell);
+                buffer.append("</cell>");
+            }
+            buffer.append("</row>\n");
+            break;
+        }
+        ++rows;
+
+        if (buffer.size() >= kBufferSize) {
+            flush();
+        }
+    }
+
+    void writeTable(const MappedTable& table) {
+        std::vector<std::string_view> cells;
+        for (size_t row = 0; row < table.rowCount(); ++row) {
+            cells.clear();
+            for (size_t column = 0; column < table.cellCount(row); ++column) {
+                cells.push_back(table.cell(row, column));
+            }
+            writeRow(cells);
+        }
+    }
+
+    void writeTable(const std::vector<std::vector<std::string>>& data) {
+        for (const auto& row : data) {
+            writeRow(row);
+        }
+    }
 
-    virtual std::vector<std::vector<std::string>> readData(const std::string& filename) = 0;
+    // Закрывает корневой элемент XML и сбрасывает буфер; повторный вызов ничего не делает.
+    void finish() {
+        if (finished) {
+            return;
+        }
+        finished = true;
+        if (format == TableFormat::Xml) {
+            buffer.append("</table>\n");
+        }
+        flush();
+        if (stream != nullptr) {
+            stream->flush();
+        }
+    }
 
-protected:
+    // Число записанных строк данных (без строки заголовка NDJSON)
+    size_t rowCount() const {
+        return rows;
+    }
 
-    void checkFileExists(const std::string& filename) {
-        std::ifstream file(filename);
-        if (!file.good()) {
-            throw std::runtime_error("File not found: " + filename);
+private:
+    int fd = -1;
+    bool ownsDescriptor = false;
+    std::ostream* stream = nullptr;
+    TableFormat format;
+    bool hasHeader;
+    bool finished = false;
+    size_t rows = 0;
+    std::string buffer;
+    std::vector<std::string> fieldNames;
+
+    void begin() {
+        buffer.reserve(kBufferSize + kBufferSize / 4);
+        if (format == TableFormat::Xml) {
+            buffer.append("<?xml version=\"1.0\" encoding=\"utf-8\"?>\n<table>\n");
+        }
+    }
+
+    void flush() {
+        if (buffer.empty()) {
+            return;
+        }
+        if (stream != nullptr) {
+            stream->write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            if (!*stream) {
+                throw std::runtime_error("Failed to write table");
+            }
+        }
+        else {
+            size_t written = 0;
+            while (written < buffer.size()) {
+#if defined(_WIN32)
+                const int result = _write(fd, buffer.data() + written,
+                    static_cast<unsigned>(std::min<size_t>(buffer.size() - written, 1u << 30)));
+#else
+                const ssize_t result = ::write(fd, buffer.data() + written, buffer.size() - written);
+                if (result < 0 && errno == EINTR) {
+                    continue;
+                }
+#endif
+                if (result < 0) {
+                    throw std::runtime_error("Failed to write table");
+                }
+                written += static_cast<size_t>(result);
+            }
+        }
+        buffer.clear();
+    }
+
+    // Таблица специальных символов формата: 1 — символ требует экранирования
+    using SpecialTable = std::array<uint8_t, 256>;
+
+    static constexpr SpecialTable makeSpecialTable(TableFormat tableFormat) {
+        SpecialTable table{};
+        for (int c = 0; c < 256; ++c) {
+            switch (tableFormat) {
+            case TableFormat::Csv: table[c] = c == ',' || c == '"' || c == '\n' || c == '\r'; break;
+            case TableFormat::Ndjson: table[c] = c < 0x20 || c == '"' || c == '\\'; break;
+            case TableFormat::Xml: table[c] = c == '&' || c == '<' || c == '>'; break;
+            }
+        }
+        return table;
+    }
+
+    // Длина начала value без специальных символов
+    static size_t plainPrefix(std::string_view value, const SpecialTable& special) {
+        size_t i = 0;
+        while (i < value.size() && !special[static_cast<unsigned char>(value[i])]) {
+            ++i;
+        }
+        return i;
+    }
+
+    void appendCsv(std::string_view value) {
+        static constexpr SpecialTable special = makeSpecialTable(TableFormat::Csv);
+        if (plainPrefix(value, special) == value.size()) {
+            buffer.append(value.data(), value.size());
+            return;
+        }
+        buffer.push_back('"');
+        size_t start = 0;
+        for (size_t quote = value.find('"'); quote != std::string_view::npos; quote = value.find('"', quote + 1)) {
+            buffer.append(value.data() + start, quote + 1 - start);
+            buffer.push_back('"');
+            start = quote + 1;
+        }
+        buffer.append(value.data() + start, value.size() - start);
+        buffer.push_back('"');
+    }
+
+    void appendJson(std::string_view value) {
+        static const char* const kHex = "0123456789abcdef";
+        static constexpr SpecialTable special = makeSpecialTable(TableFormat::Ndjson);
+        buffer.push_back('"');
+        size_t i = 0;
+        while (i < value.size()) {
+            const size_t plain = plainPrefix(value.substr(i), special);
+            buffer.append(value.data() + i, plain);
+            i += plain;
+            if (i == value.size()) {
+                break;
+            }
+            const unsigned char c = static_cast<unsigned char>(value[i++]);
+            switch (c) {
+            case '"': buffer.append("\\\""); break;
+            case '\\': buffer.append("\\\\"); break;
+            case '\n': buffer.append("\\n"); break;
+            case '\r': buffer.append("\\r"); break;
+            case '\t': buffer.append("\\t"); break;
+            default:
+                buffer.append("\\u00");
+                buffer.push_back(kHex[c >> 4]);
+                buffer.push_back(kHex[c & 0xF]);
+            }
+        }
+        buffer.push_back('"');
+    }
+
+    void appendXml(std::string_view value) {
+        static constexpr SpecialTable special = makeSpecialTable(TableFormat::Xml);
+        size_t i = 0;
+        while (i < value.size()) {
+            const size_t plain = plainPrefix(value.substr(i), special);
+            buffer.append(value.data() + i, plain);
+            i += plain;
+            if (i == value.size()) {
+                break;
+            }
+            switch (value[i++]) {
+            case '&': buffer.append("&amp;"); break;
+            case '<': buffer.append("&lt;"); break;
+            default: buffer.append("&gt;"); break;
+            }
         }
     }
 };
 
-class CSVReader : public DataReader {
+// Ключ внешней сортировки: столбец по имени заголовка, сравнение как чисел или строк.
+// Нечисловые и пустые значения числового ключа идут в конце при любом направлении.
+struct SortKey {
+    std::string column;
+    bool numeric = false;
+    bool descending = false;
+};
+
+// Внешняя сортировка CSV больше оперативной памяти. Файл отображается в память и
+// разбирается tokenizeQuoted(); записи копируются в буфер прогона в бинарном виде
+// (длина uint32 и байты каждой ячейки). Заполненный буфер сортируется и сбрасывается
+// во временный файл в отдельном потоке, пока разбор продолжается; одновременно в памяти
+// не больше threads + 1 буферов, в сумме — не больше memoryBudget. Прогоны сливаются
+// деревом проигравших (loser tree); если их больше, чем помещается буферов чтения,
+// сначала выполняются промежуточные слияния. Сортировка устойчивая. Если весь файл
+// поместился в один буфер, временные файлы не создаются.
+class ExternalCsvSorter {
 public:
-    std::vector<std::vector<std::string>> readData(const std::string& filename) override {
-        checkFileExists(filename);
+    static constexpr size_t kDefaultMemoryBudget = 256 * 1024 * 1024;
 
-        std::vector<std::vector<std::string>> data;
-        std::ifstream file(filename);
-        std::string line;
+    explicit ExternalCsvSorter(std::vector<SortKey> sortKeys, size_t memoryBudget = kDefaultMemoryBudget,
+        std::string tempDirectory = "", unsigned threads = std::thread::hardware_concurrency())
+        : keys(std::move(sortKeys)), budget(memoryBudget), temp(std::move(tempDirectory)),
+          threadCount(threads == 0 ? 1 : threads) {
+        if (keys.empty()) {
+            throw std::invalid_argument("No sort keys");
+        }
+    }
 
-        while (std::getline(file, line)) {
-            std::vector<std::string> row;
-            size_t start = 0, end = line.find(',');
+    // Вызывает onHeader(const std::vector<std::string>&) после чтения всего входа, затем
+    // onRow(const std::vector<std::string_view>&) для записей в отсортированном порядке.
+    // Ячейки действительны до следующего вызова onRow. Возвращает число записей.
+    template <typename OnHeader, typename OnRow>
+    size_t forEachSorted(const std::string& filename, OnHeader&& onHeader, OnRow&& onRow) const {
+        std::vector<std::string> header;
+        Layout layout;
+        std::optional<TempDirectory> directory;
+        std::vector<std::string> runs;
+        std::vector<std::future<void>> spills;
+        RunBuffer buffer;
+        size_t records = 0;
 
-            while (end != std::string::npos) {
-                row.push_back(line.substr(start, end - start));
-                start = end + 1;
-                end = line.find(',', start);
+        {
+            MappedFile file(filename);
+            const size_t bufferLimit = std::max<size_t>(kMinRunBuffer, budget / (threadCount + 1));
+            size_t column = 0;
+            bool inHeader = true;
+            buffer.data.reserve(std::min(bufferLimit, file.view().size()));
+
+            scanner.tokenizeQuoted(file.view(),
+                [&](std::string_view cell, bool escaped) {
+                    if (inHeader) {
+                        header.push_back(escaped ? unescape(cell) : std::string(cell));
+                    }
+                    else {
+                        appendCell(buffer.data, cell, escaped);
+                    }
+                    ++column;
+                },
+                [&]() {
+                    if (inHeader) {
+                        layout = resolveLayout(header);
+                        inHeader = false;
+                    }
+                    else {
+                        if (column != header.size()) {
+                            throw std::runtime_error("Invalid CSV format: inconsistent number of columns");
+                        }
+                        buffer.records.push_back(buffer.recordStart);
+                        buffer.recordStart = buffer.data.size();
+                        ++records;
+                        if (memoryUsage(buffer) >= bufferLimit) {
+                            if (!directory) {
+                                directory.emplace(temp);
+                            }
+                            // Не больше threadCount прогонов сортируются одновременно
+                            if (spills.size() >= threadCount) {
+                                spills[spills.size() - threadCount].get();
+                            }
+                            runs.push_back(directory->next());
+                            spills.push_back(std::async(std::launch::async,
+                                [this, &layout, run = std::move(buffer), path = runs.back()]() {
+                                    spill(layout, run, path);
+                                }));
+                            buffer = RunBuffer();
+                            buffer.data.reserve(bufferLimit);
+                        }
+                    }
+                    column = 0;
+                    return true;
+                });
+
+            if (inHeader) {
+                throw std::runtime_error("Empty CSV file");
             }
-            row.push_back(line.substr(start));
+        }
 
-            if (!data.empty() && row.size() != data[0].size()) {
-                throw std::runtime_error("Invalid CSV format: inconsistent number of columns");
+        for (auto& pending : spills) {
+            if (pending.valid()) {
+                pending.get();
             }
+        }
 
-            data.push_back(row);
+        onHeader(static_cast<const std::vector<std::string>&>(header));
+        std::vector<std::string_view> cells(header.size());
+        if (runs.empty()) {
+            for (uint32_t index : sortBuffer(layout, buffer)) {
+                decodeRecord(buffer.data.data() + buffer.records[index], cells);
+                onRow(static_cast<const std::vector<std::string_view>&>(cells));
+            }
+            return records;
         }
 
-        if (data.empty()) {
-            throw std::runtime_error("Empty CSV file");
+        if (!buffer.records.empty()) {
+            runs.push_back(directory->next());
+            spill(layout, buffer, runs.back());
+            buffer = RunBuffer();
         }
+        mergeAll(layout, runs, *directory, onRow);
+        return records;
+    }
 
-        return data;
+    // Сортирует inputFile в CSV outputFile с заголовком; выход может совпадать со входом.
+    size_t sort(const std::string& inputFile, const std::string& outputFile) const {
+        std::optional<TableWriter> writer;
+        const size_t records = forEachSorted(inputFile,
+            [&](const std::vector<std::string>& header) {
+                writer.emplace(outputFile, TableFormat::Csv, true);
+                writer->writeRow(header);
+            },
+            [&](const std::vector<std::string_view>& cells) {
+                writer->writeRow(cells);
+            });
+        writer->finish();
+        return records;
     }
-};
 
-class XMLReader : public DataReader {
-public:
-    std::vector<std::vector<std::string>> readData(const std::string& filename) override {
-        checkFileExists(filename);
+private:
+    static constexpr size_t kMinRunBuffer = 1024 * 1024;
+    static constexpr size_t kReadBufferSize = 64 * 1024;
+    static constexpr size_t kWriteBufferSize = 1024 * 1024;
 
-        std::vector<std::vector<std::string>> data;
-        std::ifstream file(filename);
-        std::string line;
-        bool inRow = false;
-        std::vector<std::string> currentRow;
+    // Число столбцов и индексы ключевых столбцов, найденные по заголовку
+    struct Layout {
+        size_t columns = 0;
+        std::vector<size_t> keyColumns;
+    };
 
-        while (std::getline(file, line)) {
-            if (line.find("<row>") != std::string::npos) {
-                if (inRow) {
-                    throw std::runtime_error("Invalid XML format: nested <row> tags");
-                }
-                inRow = true;
-                currentRow.clear();
+    struct KeyValue {
+        double number;
+        std::string_view text;
+    };
+
+    // Записи прогона подряд в бинарном виде и смещения их начала
+    struct RunBuffer {
+        std::string data;
+        std::vector<size_t> records;
+        size_t recordStart = 0;
+    };
+
+    // Временный каталог прогонов; удаляется вместе со всеми файлами
+    class TempDirectory {
+    public:
+        explicit TempDirectory(const std::string& parent) {
+            const std::filesystem::path base = parent.empty() ? std::filesystem::temp_directory_path()
+                : std::filesystem::path(parent);
+            const auto stamp = std::chrono::steady_clock::now().time_since_epoch().count();
+            path = base / ("csv_sort_" + std::to_string(stamp) + "_" + std::to_string(std::random_device()()));
+            std::filesystem::create_directories(path);
+        }
+
+        ~TempDirectory() {
+            std::error_code error;
+            std::filesystem::remove_all(path, error);
+        }
+
+        TempDirectory(const TempDirectory&) = delete;
+        TempDirectory& operator=(const TempDirectory&) = delete;
+
+        std::string next() {
+            return (path / ("run_" + std::to_string(counter++) + ".bin")).string();
+        }
+
+    private:
+        std::filesystem::path path;
+        size_t counter = 0;
+    };
+
+    class RunWriter {
+    public:
+        explicit RunWriter(const std::string& path) : output(path, std::ios::binary | std::ios::trunc) {
+            if (!output) {
+                throw std::runtime_error("Failed to create file: " + path);
             }
-            else if (line.find("<cell>") != std::string::npos) {
-                if (!inRow) {
-                    throw std::runtime_error("Invalid XML format: <cell> outside <row>");
+        }
+
+        void writeRaw(const char* data, size_t size) {
+            buffer.append(data, size);
+            if (buffer.size() >= kWriteBufferSize) {
+                flush();
+            }
+        }
+
+        void writeRecord(const std::vector<std::string_view>& cells) {
+            for (std::string_view cell : cells) {
+                const uint32_t length = static_cast<uint32_t>(cell.size());
+                buffer.append(reinterpret_cast<const char*>(&length), sizeof(length));
+                buffer.append(cell.data(), cell.size());
+            }
+            if (buffer.size() >= kWriteBufferSize) {
+                flush();
+            }
+        }
+
+        void close() {
+            flush();
+            output.close();
+            if (!output) {
+                throw std::runtime_error("Failed to write sort run");
+            }
+        }
+
+    private:
+        std::ofstream output;
+        std::string buffer;
+
+        void flush() {
+            output.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            buffer.clear();
+        }
+    };
+
+    // Последовательное чтение прогона: текущая запись копируется в record,
+    // cells указывают в неё до следующего вызова next().
+    class RunReader {
+    public:
+        RunReader(const std::string& path, size_t columns, size_t bufferSize)
+            : input(path, std::ios::binary), buffer(bufferSize), cells(columns), lengths(columns) {
+            if (!input) {
+                throw std::runtime_error("Failed to open file: " + path);
+            }
+        }
+
+        bool next() {
+            record.clear();
+            for (size_t column = 0; column < cells.size(); ++column) {
+                uint32_t length;
+                if (!read(reinterpret_cast<char*>(&length), sizeof(length))) {
+                    if (column == 0) {
+                        return false;
+                    }
+                    throw std::runtime_error("Truncated sort run");
                 }
-                size_t start = line.find("<cell>") + 6;
-                size_t end = line.find("</cell>");
-                if (end == std::string::npos) {
-                    throw std::runtime_error("Invalid XML format: unclosed <cell>");
+                lengths[column] = length;
+                const size_t start = record.size();
+                record.resize(start + length);
+                if (!read(&record[start], length)) {
+                    throw std::runtime_error("Truncated sort run");
                 }
-                currentRow.push_back(line.substr(start, end - start));
             }
-            else if (line.find("</row>") != std::string::npos) {
-                if (!inRow) {
-                    throw std::runtime_error("Invalid XML format: closing </row> without opening");
+            size_t offset = 0;
+            for (size_t column = 0; column < cells.size(); ++column) {
+                cells[column] = std::string_view(record.data() + offset, lengths[column]);
+                offset += lengths[column];
+            }
+            return true;
+        }
+
+        const std::vector<std::string_view>& current() const {
+            return cells;
+        }
+
+    private:
+        std::ifstream input;
+        std::vector<char> buffer;
+        size_t position = 0;
+        size_t available = 0;
+        std::string record;
+        std::vector<std::string_view> cells;
+        std::vector<uint32_t> lengths;
+
+        bool read(char* target, size_t size) {
+            while (size > 0) {
+                if (position == available) {
+                    input.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+                    available = static_cast<size_t>(input.gcount());
+                    position = 0;
+                    if (available == 0) {
+                        return false;
+                    }
                 }
-                inRow = false;
-                data.push_back(currentRow);
+                const size_t count = std::min(size, available - position);
+                std::memcpy(target, buffer.data() + position, count);
+                position += count;
+                target += count;
+                size -= count;
             }
+            return true;
         }
+    };
 
-        if (inRow) {
-            throw std::runtime_error("Invalid XML format: unclosed <row>");
+    std::vector<SortKey> keys;
+    size_t budget;
+    std::string temp;
+    unsigned threadCount;
+    StructuralScanner scanner{ ',' };
+
+    static std::string unescape(std::string_view cell) {
+        std::string result;
+        appendUnescaped(result, cell);
+        return result;
+    }
+
+    static void appendUnescaped(std::string& out, std::string_view cell) {
+        for (size_t i = 0; i < cell.size(); ++i) {
+            out.push_back(cell[i]);
+            if (cell[i] == '"' && i + 1 < cell.size() && cell[i + 1] == '"') {
+                ++i;
+            }
         }
+    }
 
-        if (data.empty()) {
-            throw std::runtime_error("Empty XML file");
+    static void appendCell(std::string& data, std::string_view cell, bool escaped) {
+        const size_t lengthAt = data.size();
+        data.append(sizeof(uint32_t), '\0');
+        if (escaped) {
+            appendUnescaped(data, cell);
+        }
+        else {
+            data.append(cell);
         }
+        const uint32_t length = static_cast<uint32_t>(data.size() - lengthAt - sizeof(uint32_t));
+        std::memcpy(&data[lengthAt], &length, sizeof(length));
+    }
 
+    static const char* decodeRecord(const char* data, std::vector<std::string_view>& cells) {
+        for (auto& cell : cells) {
+            uint32_t length;
+            std::memcpy(&length, data, sizeof(length));
+            cell = std::string_view(data + sizeof(length), length);
+            data += sizeof(length) + length;
+        }
         return data;
     }
+
+    Layout resolveLayout(const std::vector<std::string>& header) const {
+        Layout layout;
+        layout.columns = header.size();
+        for (const auto& key : keys) {
+            auto it = std::find(header.begin(), header.end(), key.column);
+            if (it == header.end()) {
+                throw std::invalid_argument("Unknown sort column: " + key.column);
+            }
+            layout.keyColumns.push_back(static_cast<size_t>(it - header.begin()));
+        }
+        return layout;
+    }
+
+    size_t memoryUsage(const RunBuffer& buffer) const {
+        return buffer.data.size() +
+            buffer.records.size() * (sizeof(size_t) + sizeof(uint32_t) + keys.size() * sizeof(KeyValue));
+    }
+
+    void extractKeys(const Layout& layout, const std::vector<std::string_view>& cells, KeyValue* out) const {
+        for (size_t k = 0; k < keys.size(); ++k) {
+            const std::string_view cell = cells[layout.keyColumns[k]];
+            out[k].text = cell;
+            if (keys[k].numeric && !Column::parseDouble(cell, out[k].number)) {
+                out[k].number = std::numeric_limits<double>::quiet_NaN();
+            }
+        }
+    }
+
+    int compareKeys(const KeyValue* left, const KeyValue* right) const {
+        for (size_t k = 0; k < keys.size(); ++k) {
+            int result;
+            if (keys[k].numeric) {
+                const bool leftMissing = std::isnan(left[k].number);
+                const bool rightMissing = std::isnan(right[k].number);
+                if (leftMissing || rightMissing) {
+                    result = leftMissing - rightMissing;
+                    if (result != 0) {
+                        return result;
+                    }
+                    continue;
+                }
+                result = (left[k].number > right[k].number) - (left[k].number < right[k].number);
+            }
+            else {
+                result = left[k].text.compare(right[k].text);
+                result = (result > 0) - (result < 0);
+            }
+            if (result != 0) {
+                return keys[k].descending ? -result : result;
+            }
+        }
+        return 0;
+    }
+
+    // Порядок записей буфера; при равных ключах сохраняется исходный порядок
+    std::vector<uint32_t> sortBuffer(const Layout& layout, const RunBuffer& buffer) const {
+        const size_t count = buffer.records.size();
+        std::vector<KeyValue> keyValues(count * keys.size());
+        std::vector<std::string_view> cells(*std::max_element(layout.keyColumns.begin(), layout.keyColumns.end()) + 1);
+        for (size_t record = 0; record < count; ++record) {
+            decodeRecord(buffer.data.data() + buffer.records[record], cells);
+            extractKeys(layout, cells, keyValues.data() + record * keys.size());
+        }
+
+        std::vector<uint32_t> order(count);
+        for (size_t record = 0; record < count; ++record) {
+            order[record] = static_cast<uint32_t>(record);
+        }
+        std::sort(order.begin(), order.end(), [&](uint32_t left, uint32_t right) {
+            const int result = compareKeys(keyValues.data() + left * keys.size(), keyValues.data() + right * keys.size());
+            return result != 0 ? result < 0 : left < right;
+        });
+        return order;
+    }
+
+    void spill(const Layout& layout, const RunBuffer& buffer, const std::string& path) const {
+        RunWriter writer(path);
+        for (uint32_t index : sortBuffer(layout, buffer)) {
+            const size_t start = buffer.records[index];
+            const size_t end = index + 1 < buffer.records.size() ? buffer.records[index + 1] : buffer.data.size();
+            writer.writeRaw(buffer.data.data() + start, end - start);
+        }
+        writer.close();
+    }
+
+    // Слияние k прогонов деревом проигравших: tree[0] — победитель, во внутренних узлах
+    // лежат проигравшие. После выдачи записи победитель читает следующую и проходит
+    // путь к корню за log k сравнений. При равенстве выигрывает более ранний прогон.
+    template <typename OnRow>
+    void mergeRuns(const Layout& layout, const std::vector<std::string>& paths, OnRow&& onRow) const {
+        const size_t k = paths.size();
+        const size_t readBuffer = std::max(kReadBufferSize, budget / k);
+        std::vector<std::unique_ptr<RunReader>> readers;
+        std::vector<KeyValue> keyValues(k * keys.size());
+        std::vector<uint8_t> exhausted(k);
+        for (size_t run = 0; run < k; ++run) {
+            readers.push_back(std::make_unique<RunReader>(paths[run], layout.columns, readBuffer));
+            exhausted[run] = !readers[run]->next();
+            if (!exhausted[run]) {
+                extractKeys(layout, readers[run]->current(), keyValues.data() + run * keys.size());
+            }
+        }
+
+        auto less = [&](size_t left, size_t right) {
+            if (exhausted[left] || exhausted[right]) {
+                return !exhausted[left] && exhausted[right];
+            }
+            const int result = compareKeys(keyValues.data() + left * keys.size(), keyValues.data() + right * keys.size());
+            return result != 0 ? result < 0 : left < right;
+        };
+
+        std::vector<size_t> tree(k);
+        std::vector<size_t> winners(2 * k);
+        for (size_t run = 0; run < k; ++run) {
+            winners[k + run] = run;
+        }
+        for (size_t node = k - 1; node >= 1; --node) {
+            const size_t left = winners[2 * node];
+            const size_t right = winners[2 * node + 1];
+            const bool rightWins = less(right, left);
+            winners[node] = rightWins ? right : left;
+            tree[node] = rightWins ? left : right;
+        }
+        tree[0] = winners[1];
+
+        while (!exhausted[tree[0]]) {
+            size_t winner = tree[0];
+            onRow(readers[winner]->current());
+            exhausted[winner] = !readers[winner]->next();
+            if (!exhausted[winner]) {
+                extractKeys(layout, readers[winner]->current(), keyValues.data() + winner * keys.size());
+            }
+            for (size_t node = (k + winner) / 2; node >= 1; node /= 2) {
+                if (less(tree[node], winner)) {
+                    std::swap(tree[node], winner);
+                }
+            }
+            tree[0] = winner;
+        }
+    }
+
+    // Если прогонов больше, чем буферов чтения помещается в бюджет, соседние группы
+    // прогонов сначала сливаются в новые прогоны (порядок групп сохраняет устойчивость).
+    template <typename OnRow>
+    void mergeAll(const Layout& layout, std::vector<std::string> runs, TempDirectory& directory, OnRow&& onRow) const {
+        const size_t maxFanIn = std::max<size_t>(2, budget / kReadBufferSize);
+        while (runs.size() > maxFanIn) {
+            std::vector<std::string> merged;
+            for (size_t first = 0; first < runs.size(); first += maxFanIn) {
+                const std::vector<std::string> group(runs.begin() + first,
+                    runs.begin() + std::min(runs.size(), first + maxFanIn));
+                if (group.size() == 1) {
+                    merged.push_back(group.front());
+                    continue;
+                }
+                merged.push_back(directory.next());
+                RunWriter writer(merged.back());
+                mergeRuns(layout, group, [&](const std::vector<std::string_view>& cells) {
+                    writer.writeRecord(cells);
+                });
+                writer.close();
+                for (const auto& path : group) {
+                    std::remove(path.c_str());
+                }
+            }
+            runs.swap(merged);
+        }
+        mergeRuns(layout, runs, onRow);
+    }
 };
 
 void printData(const std::vector<std::vector<std::string>>& data) {
@@ -112,11 +3543,333 @@ void printData(const std::vector<std::vector<std::string>>& data) {
         for (const auto& cell : row) {
             std::cout << cell << "\t";
         }
-        std::cout << std::endl;
+        std::cout << '\n';
+    }
+}
+
+void printData(const MappedTable& table) {
+    for (size_t row = 0; row < table.rowCount(); ++row) {
+        for (size_t column = 0; column < table.cellCount(row); ++column) {
+            std::cout << table.cell(row, column) << "\t";
+        }
+        std::cout << '\n';
+    }
+}
+
+#if defined(WITH_BENCHMARKS)
+// Сравнение пропускной способности: построчный getline + find против StructuralScanner
+void benchmarkCsvTokenizer() {
+    std::string corpus;
+    const std::string row = "Ivan,25,Moscow,Engineer,2024-01-15,42.5,active\n";
+    while (corpus.size() < 64 * 1024 * 1024) {
+        corpus += row;
+    }
+
+    auto measure = [&](const char* name, auto&& tokenize) {
+        auto start = std::chrono::steady_clock::now();
+        size_t cells = tokenize();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << name << ": " << cells << " cells, "
+            << corpus.size() / (1024.0 * 1024.0) / elapsed.count() << " MB/s\n";
+    };
+
+    measure("getline + find", [&]() {
+        size_t cells = 0;
+        std::istringstream ss(corpus);
+        std::string line;
+        while (std::getline(ss, line)) {
+            std::vector<std::string> row;
+            size_t start = 0, end = line.find(',');
+            while (end != std::string::npos) {
+                row.push_back(line.substr(start, end - start));
+                start = end + 1;
+                end = line.find(',', start);
+            }
+            row.push_back(line.substr(start));
+            cells += row.size();
+        }
+        return cells;
+    });
+
+    measure("StructuralScanner", [&]() {
+        size_t cells = 0;
+        StructuralScanner scanner(',');
+        scanner.tokenize(corpus,
+            [&](std::string_view) { ++cells; },
+            []() { return true; });
+        return cells;
+    });
+}
+
+// Масштабирование ParallelCSVReader по числу потоков на сгенерированном файле
+void benchmarkParallelCsvReader() {
+    const std::string filename = "bench_parallel.csv";
+    {
+        std::ofstream file(filename, std::ios::binary);
+        std::string block;
+        for (int i = 0; i < 10000; ++i) {
+            block += "Ivan,25,Moscow,\"Engineer, senior\",2024-01-15,42.5,\"said \"\"hi\"\"\"\n";
+        }
+        for (size_t written = 0; written < 256 * 1024 * 1024; written += block.size()) {
+            file << block;
+        }
+    }
+
+    const unsigned maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned threads = 1; threads <= maxThreads; threads *= 2) {
+        ParallelCSVReader reader(threads);
+        auto start = std::chrono::steady_clock::now();
+        MappedTable table = reader.readMapped(filename);
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << "ParallelCSVReader, " << threads << " threads: " << table.rowCount() << " rows, "
+            << elapsed.count() * 1000.0 << " ms\n";
+    }
+
+    std::remove(filename.c_str());
+}
+
+// Корпуса и прогоны режима --bench; общая обвязка — bench/bench_harness.h
+std::string makeCsvHeader(size_t columns) {
+    std::string header;
+    for (size_t i = 0; i < columns; ++i) {
+        header += (i ? ",col" : "col") + std::to_string(i);
+    }
+    return header;
+}
+
+std::string makeCell(size_t column, size_t n) {
+    switch (column % 4) {
+    case 0: return std::to_string(n);
+    case 1: return "user" + std::to_string(n);
+    case 2: return "user" + std::to_string(n) + "@example.com";
+    default: return "42.5";
+    }
+}
+
+// Типизированная строка корпуса: первые четыре столбца (число, имя, email, дробное)
+struct BenchRow {
+    int64_t id = 0;
+    std::string name;
+    std::string email;
+    double score = 0.0;
+};
+
+template <>
+struct CsvSchema<BenchRow> {
+    static constexpr auto columns = std::make_tuple(
+        bindColumn("col0", &BenchRow::id),
+        bindColumn("col1", &BenchRow::name),
+        bindColumn("col2", &BenchRow::email),
+        bindColumn("col3", &BenchRow::score));
+};
+
+// Пишет CSV-корпус с заголовком не меньше targetBytes; возвращает число строк данных
+size_t writeCsvCorpus(const std::string& filename, size_t columns, size_t targetBytes) {
+    std::string text = makeCsvHeader(columns) + "\n";
+    size_t rows = 0;
+    while (text.size() < targetBytes) {
+        for (size_t i = 0; i < columns; ++i) {
+            if (i) {
+                text.push_back(',');
+            }
+            text += makeCell(i, rows);
+        }
+        text.push_back('\n');
+        ++rows;
+    }
+    std::ofstream(filename, std::ios::binary).write(text.data(), text.size());
+    return rows;
+}
+
+// XML-корпус: <row> и по одному <cell> на строке
+size_t writeXmlCorpus(const std::string& filename, size_t columns, size_t targetBytes) {
+    std::string text = "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n";
+    size_t rows = 0;
+    while (text.size() < targetBytes) {
+        text += "<row>\n";
+        for (size_t i = 0; i < columns; ++i) {
+            text += "\t<cell>" + makeCell(i, rows) + "</cell>\n";
+        }
+        text += "</row>\n";
+        ++rows;
+    }
+    std::ofstream(filename, std::ios::binary).write(text.data(), text.size());
+    return rows;
+}
+
+size_t fileSize(const std::string& filename) {
+    return static_cast<size_t>(std::ifstream(filename, std::ios::binary | std::ios::ate).tellg());
+}
+
+void runBenchmarks(size_t limit) {
+    const std::string csvFile = "bench_corpus.csv";
+    const std::string xmlFile = "bench_corpus.xml";
+    const std::string cacheDirectory = "bench_snapshots";
+    const std::string outputFile = "bench_output";
+    CSVReader csvReader;
+    ParallelCSVReader parallelReader;
+    XMLReader xmlReader;
+    TypedCsvReader<BenchRow> typedReader;
+
+    for (size_t corpusSize : kCorpusSizes) {
+        if (corpusSize > limit) {
+            break;
+        }
+
+        for (size_t columns : { kNarrowColumns, kWideColumns }) {
+            const std::string shape = columns == kNarrowColumns ? " narrow" : " wide";
+
+            const size_t csvRows = writeCsvCorpus(csvFile, columns, corpusSize);
+            const size_t csvBytes = fileSize(csvFile);
+            runBenchmark("CSVReader" + shape + " readData", corpusSize, csvBytes, csvRows, [&]() {
+                csvReader.readData(csvFile);
+            });
+            runBenchmark("CSVReader" + shape + " readMapped", corpusSize, csvBytes, csvRows, [&]() {
+                csvReader.readMapped(csvFile);
+            });
+            runBenchmark("CSVReader" + shape + " readColumnar", corpusSize, csvBytes, csvRows, [&]() {
+                csvReader.readColumnar(csvFile);
+            });
+            runBenchmark("ParallelCSVReader" + shape + " readMapped", corpusSize, csvBytes, csvRows, [&]() {
+                parallelReader.readMapped(csvFile);
+            });
+            runBenchmark("TypedCsvReader" + shape + " forEach", corpusSize, csvBytes, csvRows, [&]() {
+                typedReader.forEach(csvFile, [](BenchRow&&) {});
+            });
+            csvReader.readCached(csvFile, cacheDirectory);
+            runBenchmark("CSVReader" + shape + " readCached (warm)", corpusSize, csvBytes, csvRows, [&]() {
+                csvReader.readCached(csvFile, cacheDirectory);
+            });
+            const ColumnarTable columnar = csvReader.readColumnar(csvFile);
+            const std::string median = std::to_string(csvRows / 2);
+            runBenchmark("TableQuery" + shape + " filter + group-by", corpusSize, csvBytes, csvRows, [&]() {
+                TableQuery(columnar).where("col0", CompareOp::Greater, median).groupBy({ "col3" })
+                    .aggregate(AggregateFunction::Count).aggregate(AggregateFunction::Avg, "col0").run();
+            });
+            runBenchmark("TableQuery" + shape + " top-k", corpusSize, csvBytes, csvRows, [&]() {
+                TableQuery(columnar).select({ "col0", "col1" }).orderBy("col0", true).limit(10).run();
+            });
+            MappedTable table = csvReader.readMapped(csvFile);
+            for (auto [format, formatName] : { std::make_pair(TableFormat::Csv, " csv"),
+                std::make_pair(TableFormat::Ndjson, " ndjson"), std::make_pair(TableFormat::Xml, " xml") }) {
+                runBenchmark("TableWriter" + shape + formatName, corpusSize, csvBytes, csvRows, [&]() {
+                    TableWriter writer(outputFile, format, true);
+                    writer.writeTable(table);
+                });
+            }
+            ExternalCsvSorter sorter({ { "col1" } }, std::max<size_t>(csvBytes / 4, 1));
+            runBenchmark("ExternalCsvSorter" + shape + " sort", corpusSize, csvBytes, csvRows, [&]() {
+                sorter.sort(csvFile, outputFile);
+            });
+            std::remove(outputFile.c_str());
+            std::remove(csvFile.c_str());
+
+            const size_t xmlRows = writeXmlCorpus(xmlFile, columns, corpusSize);
+            const size_t xmlBytes = fileSize(xmlFile);
+            runBenchmark("XMLReader" + shape + " readData", corpusSize, xmlBytes, xmlRows, [&]() {
+                xmlReader.readData(xmlFile);
+            });
+            runBenchmark("XMLReader" + shape + " readMapped", corpusSize, xmlBytes, xmlRows, [&]() {
+                xmlReader.readMapped(xmlFile);
+            });
+            std::remove(xmlFile.c_str());
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::remove_all(cacheDirectory, error);
+}
+#endif
+
+struct Person {
+    std::string name;
+    int age = 0;
+    std::string city;
+};
+
+template <>
+struct CsvSchema<Person> {
+    static constexpr auto columns = std::make_tuple(
+        bindColumn("Name", &Person::name),
+        bindColumn("Age", &Person::age),
+        bindColumn("City", &Person::city));
+};
+
+// Режим --verify: проверки TableQuery на граничных значениях int64_t.
+int verifyTableQuery() {
+    const std::string file = (std::filesystem::temp_directory_path() / "table_query_verify.csv").string();
+    size_t failures = 0;
+    auto check = [&](const std::string& name, bool passed, const std::string& detail) {
+        std::cout << name << ": " << (passed ? "ok" : "FAILED") << " (" << detail << ")" << std::endl;
+        failures += !passed;
+    };
+
+    // Две половины по 65536 строк: частичная сумма каждого потока помещается в int64_t,
+    // а их слияние — нет. Сумма 2^64 - 131072 представима в double точно.
+    const size_t rows = 2 * 64 * 1024;
+    const int64_t value = (int64_t(1) << 47) - 1;
+    {
+        std::ofstream out(file, std::ios::binary);
+        out << "value\n";
+        for (size_t row = 0; row < rows; ++row) {
+            out << value << '\n';
+        }
     }
+    const ColumnarTable table = CSVReader().readColumnar(file);
+    std::remove(file.c_str());
+
+    const double expected = static_cast<double>(value) * static_cast<double>(rows);
+    for (unsigned threads : { 1u, 2u }) {
+        const QueryResult result = TableQuery(table).threads(threads)
+            .aggregate(AggregateFunction::Sum, "value")
+            .aggregate(AggregateFunction::Avg, "value")
+            .aggregate(AggregateFunction::Max, "value")
+            .run();
+        const std::vector<std::string>& cells = result.rows.at(0);
+        const std::string suffix = " with " + std::to_string(threads) + " thread(s)";
+        check("Int64 sum overflow" + suffix, std::stod(cells[0]) == expected, cells[0]);
+        check("Int64 avg overflow" + suffix, std::stod(cells[1]) == static_cast<double>(value), cells[1]);
+        check("Int64 max" + suffix, cells[2] == std::to_string(value), cells[2]);
+    }
+
+    // Соседние целые выше 2^53 совпадают в double, но не в int64_t
+    {
+        std::ofstream out(file, std::ios::binary);
+        out << "id\n9007199254740992\n9007199254740993\n9007199254740994\n";
+    }
+    const ColumnarTable ids = CSVReader().readColumnar(file);
+    std::remove(file.c_str());
+    auto matching = [&](CompareOp op, const std::string& bound) {
+        std::string rowsText;
+        for (const auto& row : TableQuery(ids).where("id", op, bound).select({ "id" }).run().rows) {
+            rowsText += (rowsText.empty() ? "" : " ") + row[0];
+        }
+        return rowsText;
+    };
+    const std::string equal = matching(CompareOp::Equal, "9007199254740993");
+    check("Int64 equal above 2^53", equal == "9007199254740993", equal);
+    const std::string greater = matching(CompareOp::Greater, "9007199254740992");
+    check("Int64 greater above 2^53", greater == "9007199254740993 9007199254740994", greater);
+    const std::string fractional = matching(CompareOp::GreaterEqual, "1.5");
+    check("Int64 against fractional bound", fractional == "9007199254740992 9007199254740993 9007199254740994",
+        fractional);
+
+    return failures == 0 ? 0 : 1;
 }
 
-int main() {
+int main(int argc, char* argv[]) {
+    if (argc > 1 && std::string(argv[1]) == "--verify") {
+        return verifyTableQuery();
+    }
+#if defined(WITH_BENCHMARKS)
+    if (argc > 1 && std::string(argv[1]) == "--bench") {
+        runBenchmarks(argc > 2 ? std::stoull(argv[2]) << 20 : kDefaultBenchLimit);
+        benchmarkCsvTokenizer();
+        benchmarkParallelCsvReader();
+        return 0;
+    }
+#endif
+
     try {
         CSVReader csvReader;
         auto csvData = csvReader.readData("data.csv");
@@ -128,6 +3881,90 @@ int main() {
         std::cout << "\nXML Data:" << std::endl;
         printData(xmlData);
 
+        MappedTable mappedCsv = csvReader.readMapped("data.csv");
+        std::cout << "\nMapped CSV Data (" << mappedCsv.rowCount() << " rows):" << std::endl;
+        printData(mappedCsv);
+
+        std::istringstream minifiedXml("<table><row><cell>Name</cell><cell>City</cell></row>"
+            "<row><cell>Anna</cell><cell>St. Petersburg &amp; Moscow</cell></row></table>");
+        std::cout << "\nStreamed XML Data:" << std::endl;
+        xmlReader.readStream(minifiedXml, [](const std::vector<std::string_view>& cells) {
+            for (std::string_view cell : cells) {
+                std::cout << cell << "\t";
+            }
+            std::cout << std::endl;
+        });
+
+        ReadCheckpoint checkpoint;
+        MappedTable appended = csvReader.readAppended("data.csv", checkpoint);
+        std::cout << "\nAppended CSV Data (" << appended.rowCount() << " new rows, offset "
+            << checkpoint.offset << "):" << std::endl;
+        printData(appended);
+        std::cout << "New rows on second call: " << csvReader.readAppended("data.csv", checkpoint).rowCount() << std::endl;
+
+        MappedTable cachedCsv = csvReader.readCached("data.csv", "snapshots");
+        std::cout << "\nCached CSV Data (" << cachedCsv.rowCount() << " rows):" << std::endl;
+        printData(cachedCsv);
+
+        ParallelCSVReader parallelReader;
+        MappedTable parallelCsv = parallelReader.readMapped("data.csv");
+        std::cout << "\nParallel CSV Data (" << parallelCsv.rowCount() << " rows):" << std::endl;
+        printData(parallelCsv);
+
+        for (auto [format, formatName] : { std::make_pair(TableFormat::Csv, "CSV"),
+            std::make_pair(TableFormat::Ndjson, "NDJSON"), std::make_pair(TableFormat::Xml, "XML") }) {
+            std::cout << "\nWritten as " << formatName << ":" << std::endl;
+            TableWriter writer(std::cout, format, true);
+            writer.writeTable(mappedCsv);
+        }
+
+        TypedCsvReader<Person> typedReader;
+        std::vector<Person> people = typedReader.read("data.csv");
+        std::cout << "\nTyped CSV Data (" << people.size() << " rows):" << std::endl;
+        for (const Person& person : people) {
+            std::cout << person.name << "\t" << person.age << "\t" << person.city << std::endl;
+        }
+
+        ColumnarTable columnar = csvReader.readColumnar("data.csv");
+        auto printResult = [](const QueryResult& result) {
+            TableWriter writer(std::cout, TableFormat::Csv, true);
+            writer.writeRow(result.columns);
+            writer.writeTable(result.rows);
+        };
+        QueryResult averages = TableQuery(columnar)
+            .groupBy({ "City" })
+            .aggregate(AggregateFunction::Avg, "Age")
+            .aggregate(AggregateFunction::Count)
+            .orderBy("City")
+            .run();
+        std::cout << "\nAverage Age per City:" << std::endl;
+        printResult(averages);
+
+        QueryResult oldest = TableQuery(columnar)
+            .where("Age", CompareOp::GreaterEqual, "18")
+            .select({ "Name", "Age" })
+            .orderBy("Age", true)
+            .limit(3)
+            .run();
+        std::cout << "\nOldest adults:" << std::endl;
+        printResult(oldest);
+
+        ExternalCsvSorter sorter({ { "City" }, { "Age", true, true } });
+        std::cout << "\nSorted by City, Age descending:" << std::endl;
+        sorter.forEachSorted("data.csv",
+            [](const std::vector<std::string>& header) {
+                for (const auto& name : header) {
+                    std::cout << name << "\t";
+                }
+                std::cout << "\n";
+            },
+            [](const std::vector<std::string_view>& cells) {
+                for (std::string_view cell : cells) {
+                    std::cout << cell << "\t";
+                }
+                std::cout << "\n";
+            });
+
     }
     catch (const std::exception& e) {
         std::cerr << "Error: " << e.what() << std::endl;
@@ -1,29 +1,421 @@
 ﻿#include <iostream>
+#include <fstream>
 #include <stdexcept>
 #include <string>
 #include <vector>
 #include <map>
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <functional>
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string_view>
+#include <thread>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <new>
+
+#if defined(WITH_BENCHMARKS)
+#include "../bench/bench_harness.h"
+#endif
+
+
+// Арена блоков: копирует строки в заранее выделенные блоки, reset() за O(1)
+// возвращает её в начало без освобождения памяти.
+class Arena {
+public:
+    static constexpr size_t kBlockSize = 64 * 1024;
+
+    std::string_view copy(std::string_view value) {
+        if (value.empty()) {
+            return std::string_view("", 0);
+        }
+        if (blocks.empty() || used + value.size() > blocks[current].size) {
+            nextBlock(value.size());
+        }
+        char* target = blocks[current].data.get() + used;
+        std::memcpy(target, value.data(), value.size());
+        used += value.size();
+        return std::string_view(target, value.size());
+    }
+
+    void reset() {
+        current = 0;
+        used = 0;
+    }
+
+private:
+    struct Block {
+        std::unique_ptr<char[]> data;
+        size_t size;
+    };
+
+    std::vector<Block> blocks;
+    size_t current = 0;
+    size_t used = 0;
+
+    void nextBlock(size_t required) {
+        if (!blocks.empty()) {
+            ++current;
+        }
+        while (current < blocks.size() && blocks[current].size < required) {
+            ++current;
+        }
+        if (current >= blocks.size()) {
+            const size_t size = std::max(kBlockSize, required);
+            blocks.push_back(Block{ std::unique_ptr<char[]>(new char[size]), size });
+            current = blocks.size() - 1;
+        }
+        used = 0;
+    }
+};
+
+// Переиспользуемый контекст разбора: ключи интернируются и живут между записями,
+// значения копируются в арену. Плоская хеш-таблица с открытой адресацией;
+// reset() за O(1) увеличивает номер поколения, делая все значения недействительными.
+// Ключи не вытесняются по одному: если их накопилось больше kMaxKeys (индексы массивов,
+// идентификаторы в именах полей), reset() очищает таблицу и арену ключей целиком.
+class ParseContext {
+public:
+    static constexpr size_t kMaxKeys = 64 * 1024;
+
+    ParseContext() : slots(kInitialCapacity) {}
+
+    void reset() {
+        ++generation;
+        values.reset();
+        order.clear();
+        if (keyCount > kMaxKeys) {
+            std::vector<Slot>(kInitialCapacity).swap(slots);
+            keys = Arena();
+            keyCount = 0;
+        }
+    }
+
+    void set(std::string_view key, std::string_view value) {
+        if ((keyCount + 1) * 2 > slots.size()) {
+            grow();
+        }
+
+        const uint64_t hash = hashKey(key);
+        Slot& slot = slots[findIndex(key, hash)];
+        if (slot.key.data() == nullptr) {
+            slot.key = keys.copy(key);
+            slot.hash = hash;
+            ++keyCount;
+        }
+        if (slot.generation != generation) {
+            slot.generation = generation;
+            order.push_back(static_cast<uint32_t>(&slot - slots.data()));
+        }
+        slot.value = values.copy(value);
+    }
+
+    // Значение ключа в текущей записи; nullptr, если ключа нет
+    const std::string_view* find(std::string_view key) const {
+        const Slot& slot = slots[findIndex(key, hashKey(key))];
+        return slot.key.data() != nullptr && slot.generation == generation ? &slot.value : nullptr;
+    }
+
+    size_t size() const {
+        return order.size();
+    }
+
+    // Обход пар текущей записи в порядке вставки
+    template <typename Visitor>
+    void forEach(Visitor&& visitor) const {
+        for (uint32_t index : order) {
+            visitor(slots[index].key, slots[index].value);
+        }
+    }
+
+    std::map<std::string, std::string> toMap() const {
+        std::map<std::string, std::string> result;
+        forEach([&](std::string_view key, std::string_view value) {
+            result[std::string(key)] = std::string(value);
+        });
+        return result;
+    }
+
+private:
+    static constexpr size_t kInitialCapacity = 64;
+
+    struct Slot {
+        std::string_view key;
+        std::string_view value;
+        uint64_t hash = 0;
+        uint64_t generation = 0;
+    };
+
+    std::vector<Slot> slots;
+    std::vector<uint32_t> order;
+    Arena keys;
+    Arena values;
+    size_t keyCount = 0;
+    uint64_t generation = 1;
+
+    static uint64_t hashKey(std::string_view key) {
+        uint64_t hash = 14695981039346656037ull;
+        for (char c : key) {
+            hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ull;
+        }
+        return hash;
+    }
+
+    size_t findIndex(std::string_view key, uint64_t hash) const {
+        const size_t mask = slots.size() - 1;
+        for (size_t index = hash & mask;; index = (index + 1) & mask) {
+            const Slot& slot = slots[index];
+            if (slot.key.data() == nullptr || (slot.hash == hash && slot.key == key)) {
+                return index;
+            }
+        }
+    }
+
+    void grow() {
+        std::vector<Slot> old(slots.size() * 2);
+        old.swap(slots);
+        const size_t mask = slots.size() - 1;
+        std::vector<uint32_t> remap(old.size(), 0);
+        for (size_t i = 0; i < old.size(); ++i) {
+            if (old[i].key.data() == nullptr) {
+                continue;
+            }
+            size_t index = old[i].hash & mask;
+            while (slots[index].key.data() != nullptr) {
+                index = (index + 1) & mask;
+            }
+            slots[index] = old[i];
+            remap[i] = static_cast<uint32_t>(index);
+        }
+        for (uint32_t& index : order) {
+            index = remap[index];
+        }
+    }
+};
+
+
+enum class ProcessStatus {
+    Ok,
+    InvalidArgument,
+    ParseError
+};
+
+
+// Результат обработки одной записи пакета
+struct BatchResult {
+    ProcessStatus status = ProcessStatus::Ok;
+    std::string message;
+    std::map<std::string, std::string> values;
+};
 
 
 class DataProcessor {
 protected:
 
-    void checkDataNotEmpty(const std::string& data) const {
-        if (data.empty()) {
-            throw std::invalid_argument("Data cannot be empty");
-        }
+    static ProcessStatus reject(std::string& message, ProcessStatus status, const std::string& text) {
+        message = text;
+        return status;
     }
 
 
-    virtual bool isValidData(const std::string& data) const {
+    virtual bool isValidData(std::string_view data) const {
         return !data.empty();
     }
 
+private:
+    // Постоянный пул processBatch(): потоки создаются при первом вызове и живут вместе
+    // с процессором, у каждого (и у вызывающего потока) свой клон и ParseContext.
+    // Пакет раздаётся по номеру поколения через condition_variable.
+    class BatchPool {
+    public:
+        using Job = std::function<void(DataProcessor&, ParseContext&)>;
+
+        explicit BatchPool(const DataProcessor& owner) : prototype(owner), caller{ owner.clone(), {} } {}
+
+        BatchPool(const BatchPool&) = delete;
+        BatchPool& operator=(const BatchPool&) = delete;
+
+        ~BatchPool() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopping = true;
+            }
+            wake.notify_all();
+            for (auto& thread : threads) {
+                thread.join();
+            }
+        }
+
+        // Выполняет job в workerCount потоках, считая вызывающий; пакеты идут по одному
+        void run(size_t workerCount, const Job& job) {
+            std::lock_guard<std::mutex> batchLock(batchMutex);
+            while (workers.size() + 1 < workerCount) {
+                workers.push_back(std::make_unique<Worker>(Worker{ prototype.clone(), {} }));
+                Worker* worker = workers.back().get();
+                const size_t index = workers.size() - 1;
+                std::lock_guard<std::mutex> lock(mutex);
+                threads.emplace_back([this, worker, index, seen = generation]() {
+                    workerLoop(*worker, index, seen);
+                });
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                currentJob = &job;
+                activeWorkers = workerCount - 1;
+                running = activeWorkers;
+                failure = nullptr;
+                ++generation;
+            }
+            wake.notify_all();
+
+            std::exception_ptr callerFailure;
+            try {
+                job(*caller.processor, caller.context);
+            }
+            catch (...) {
+                callerFailure = std::current_exception();
+            }
+
+            std::unique_lock<std::mutex> lock(mutex);
+            done.wait(lock, [this]() { return running == 0; });
+            currentJob = nullptr;
+            if (callerFailure) {
+                std::rethrow_exception(callerFailure);
+            }
+            if (failure) {
+                std::rethrow_exception(failure);
+            }
+        }
+
+    private:
+        struct Worker {
+            std::unique_ptr<DataProcessor> processor;
+            ParseContext context;
+        };
+
+        const DataProcessor& prototype;
+        Worker caller;
+        std::vector<std::unique_ptr<Worker>> workers;
+        std::vector<std::thread> threads;
+        std::mutex batchMutex;
+
+        std::mutex mutex;
+        std::condition_variable wake;
+        std::condition_variable done;
+        const Job* currentJob = nullptr;
+        size_t activeWorkers = 0;
+        size_t running = 0;
+        uint64_t generation = 0;
+        bool stopping = false;
+        std::exception_ptr failure;
+
+        void workerLoop(Worker& worker, size_t index, uint64_t seen) {
+            for (;;) {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [&]() { return stopping || generation != seen; });
+                if (stopping) {
+                    return;
+                }
+                seen = generation;
+                if (index >= activeWorkers) {
+                    continue;
+                }
+                const Job& job = *currentJob;
+                lock.unlock();
+
+                try {
+                    job(*worker.processor, worker.context);
+                }
+                catch (...) {
+                    std::lock_guard<std::mutex> failureLock(mutex);
+                    if (!failure) {
+                        failure = std::current_exception();
+                    }
+                }
+
+                lock.lock();
+                if (--running == 0) {
+                    done.notify_one();
+                }
+            }
+        }
+    };
+
+    mutable std::once_flag batchPoolOnce;
+    mutable std::unique_ptr<BatchPool> batchPool;
+
 public:
+    static constexpr size_t kBatchChunkSize = 256;
+
     virtual ~DataProcessor() = default;
 
 
-    virtual std::map<std::string, std::string> process(const std::string& data) = 0;
+    // Основной разбор без исключений: при ошибке возвращает статус и заполняет message.
+    virtual ProcessStatus tryProcess(std::string_view data, ParseContext& context, std::string& message) = 0;
+
+
+    // Копия процессора с теми же настройками для отдельного потока
+    virtual std::unique_ptr<DataProcessor> clone() const = 0;
+
+
+    // Разбор в переиспользуемый контекст: после прогрева не выделяет память.
+    void process(std::string_view data, ParseContext& context) {
+        std::string message;
+        switch (tryProcess(data, context, message)) {
+        case ProcessStatus::Ok:
+            return;
+        case ProcessStatus::InvalidArgument:
+            throw std::invalid_argument(message);
+        default:
+            throw std::runtime_error(message);
+        }
+    }
+
+
+    // Удобная обёртка: разбирает запись во временный контекст и копирует его в map.
+    std::map<std::string, std::string> process(const std::string& data) {
+        ParseContext context;
+        process(data, context);
+        return context.toMap();
+    }
+
+
+    // Пакетная обработка: записи распределяются по потокам блоками по kBatchChunkSize,
+    // у каждого потока постоянного пула свой клон процессора и контекст. Результаты идут в порядке
+    // входных записей, ошибки возвращаются статусом без исключений.
+    std::vector<BatchResult> processBatch(const std::vector<std::string_view>& records,
+        unsigned threadCount = std::thread::hardware_concurrency()) const {
+        std::vector<BatchResult> results(records.size());
+        const size_t chunks = (records.size() + kBatchChunkSize - 1) / kBatchChunkSize;
+        const size_t workerCount = std::max<size_t>(1, std::min<size_t>(threadCount, chunks));
+        std::atomic<size_t> nextChunk{ 0 };
+
+        std::call_once(batchPoolOnce, [this]() { batchPool = std::make_unique<BatchPool>(*this); });
+        batchPool->run(workerCount, [&](DataProcessor& processor, ParseContext& context) {
+            for (size_t chunk = nextChunk++; chunk < chunks; chunk = nextChunk++) {
+                const size_t end = std::min(records.size(), (chunk + 1) * kBatchChunkSize);
+                for (size_t i = chunk * kBatchChunkSize; i < end; ++i) {
+                    BatchResult& result = results[i];
+                    result.status = processor.tryProcess(records[i], context, result.message);
+                    if (result.status == ProcessStatus::Ok) {
+                        result.values = context.toMap();
+                    }
+                }
+            }
+        });
+
+        return results;
+    }
 
 
     virtual std::string getProcessorType() const = 0;
@@ -31,177 +423,915 @@ public:
 
 
 class CSVProcessor : public DataProcessor {
+public:
+    using RecordCallback = std::function<void(const std::vector<std::string_view>& headers,
+        const std::vector<std::string_view>& values)>;
+
+    static constexpr size_t kStreamBlockSize = 64 * 1024;
+
 private:
     char delimiter;
+    std::vector<std::string_view> headerFields;
+    std::vector<std::string_view> valueFields;
+
 
+    void splitFields(std::string_view line, std::vector<std::string_view>& fields) const {
+        fields.clear();
+        size_t pos = 0;
+        size_t end;
+        while ((end = line.find(delimiter, pos)) != std::string_view::npos) {
+            fields.push_back(line.substr(pos, end - pos));
+            pos = end + 1;
+        }
+        fields.push_back(line.substr(pos));
+    }
 
-    bool isValidData(const std::string& data) const override {
-        size_t delimiterCount = std::count(data.begin(), data.end(), delimiter);
-        return delimiterCount > 0 && data.find('\n') != std::string::npos;
+
+    bool isValidData(std::string_view data) const override {
+        return data.find(delimiter) != std::string_view::npos && data.find('\n') != std::string_view::npos;
     }
 
 public:
     explicit CSVProcessor(char delim = ',') : delimiter(delim) {}
 
-    std::map<std::string, std::string> process(const std::string& data) override {
-        checkDataNotEmpty(data);
+    std::unique_ptr<DataProcessor> clone() const override {
+        return std::make_unique<CSVProcessor>(delimiter);
+    }
+
+    ProcessStatus tryProcess(std::string_view data, ParseContext& context, std::string& message) override {
+        if (data.empty()) {
+            return reject(message, ProcessStatus::InvalidArgument, "Data cannot be empty");
+        }
 
         if (!isValidData(data)) {
-            throw std::runtime_error("Invalid CSV format");
+            return reject(message, ProcessStatus::ParseError, "Invalid CSV format");
         }
 
-        std::map<std::string, std::string> result;
-        std::vector<std::string> lines;
-        size_t pos = 0;
-        size_t end;
+        context.reset();
+        size_t headerEnd = data.find('\n');
+        if (headerEnd == std::string_view::npos) {
+            return reject(message, ProcessStatus::ParseError, "Missing data row in CSV");
+        }
 
+        size_t valuesEnd = data.find('\n', headerEnd + 1);
+        if (valuesEnd == std::string_view::npos) {
+            valuesEnd = data.size();
+        }
 
-        while ((end = data.find('\n', pos)) != std::string::npos) {
-            lines.push_back(data.substr(pos, end - pos));
-            pos = end + 1;
+        splitFields(data.substr(0, headerEnd), headerFields);
+        splitFields(data.substr(headerEnd + 1, valuesEnd - headerEnd - 1), valueFields);
+
+
+        if (headerFields.size() != valueFields.size()) {
+            return reject(message, ProcessStatus::ParseError, "CSV headers and values count mismatch");
         }
-        lines.push_back(data.substr(pos));
 
 
-        if (lines.empty()) {
+        for (size_t i = 0; i < headerFields.size(); ++i) {
+            context.set(headerFields[i], valueFields[i]);
+        }
+        return ProcessStatus::Ok;
+    }
+
+
+    // Потоковый режим: обходит все записи за один проход с буфером постоянного размера.
+    // Поля в колбэке указывают в буфер чтения и действительны только до возврата из него.
+    size_t processStream(std::istream& input, const RecordCallback& onRecord) const {
+        std::vector<char> buffer(kStreamBlockSize);
+        size_t begin = 0;
+        size_t end = 0;
+        bool eof = false;
+
+        std::vector<std::string> headerStorage;
+        std::vector<std::string_view> headers;
+        std::vector<std::string_view> values;
+        size_t records = 0;
+        size_t lineNumber = 0;
+
+        auto handleLine = [&](std::string_view line) {
+            ++lineNumber;
+            if (!line.empty() && line.back() == '\r') {
+                line.remove_suffix(1);
+            }
+            if (line.empty()) {
+                return;
+            }
+
+            if (headers.empty()) {
+                splitFields(line, values);
+                headerStorage.assign(values.begin(), values.end());
+                headers.assign(headerStorage.begin(), headerStorage.end());
+                return;
+            }
+
+            splitFields(line, values);
+            if (values.size() != headers.size()) {
+                throw std::runtime_error("CSV headers and values count mismatch at line " +
+                    std::to_string(lineNumber));
+            }
+
+            onRecord(headers, values);
+            ++records;
+        };
+
+        while (true) {
+            const char* data = buffer.data();
+            const void* newline = begin < end ? std::memchr(data + begin, '\n', end - begin) : nullptr;
+
+            if (newline) {
+                size_t lineEnd = static_cast<const char*>(newline) - data;
+                handleLine(std::string_view(data + begin, lineEnd - begin));
+                begin = lineEnd + 1;
+                continue;
+            }
+
+            if (eof) {
+                if (begin < end) {
+                    handleLine(std::string_view(data + begin, end - begin));
+                }
+                break;
+            }
+
+            // Незавершённая строка переносится в начало буфера; буфер растёт
+            // только если одна запись длиннее блока.
+            if (begin > 0) {
+                std::memmove(buffer.data(), buffer.data() + begin, end - begin);
+                end -= begin;
+                begin = 0;
+            }
+            if (end == buffer.size()) {
+                buffer.resize(buffer.size() * 2);
+            }
+
+            input.read(buffer.data() + end, static_cast<std::streamsize>(buffer.size() - end));
+            size_t got = static_cast<size_t>(input.gcount());
+            end += got;
+            if (got == 0 || !input) {
+                if (input.bad()) {
+                    throw std::runtime_error("Error reading CSV stream");
+                }
+                eof = true;
+            }
+        }
+
+        if (headers.empty()) {
             throw std::runtime_error("No data in CSV");
         }
 
-        std::vector<std::string> headers;
+        return records;
+    }
+
+    std::string getProcessorType() const override {
+        return "CSV Processor (delimiter: '" + std::string(1, delimiter) + "')";
+    }
+};
+
+
+// Потоковый (SAX) токенизатор JSON: за один проход вызывает onValue(path, value) для
+// каждого скалярного значения, вложенные объекты и массивы разворачиваются в пути
+// вида "user.address.city" и "tags.0". DOM не строится; буферы пути и строк
+// переиспользуются между документами. Ошибки не бросаются: parse() возвращает false,
+// описание доступно через error().
+class JsonTokenizer {
+public:
+    static constexpr size_t kMaxDepth = 256;
+
+    template <typename OnValue>
+    bool parse(std::string_view input, OnValue&& onValue) {
+        text = input;
         pos = 0;
-        while ((end = lines[0].find(delimiter, pos)) != std::string::npos) {
-            headers.push_back(lines[0].substr(pos, end - pos));
-            pos = end + 1;
+        path.clear();
+        errorMessage = nullptr;
+
+        skipWhitespace();
+        if (pos >= text.size() || (text[pos] != '{' && text[pos] != '[')) {
+            return fail("Malformed structure");
+        }
+        if (!parseValue(onValue, 0)) {
+            return false;
         }
-        headers.push_back(lines[0].substr(pos));
 
+        skipWhitespace();
+        if (pos != text.size()) {
+            return fail("Unexpected trailing characters");
+        }
+        return true;
+    }
+
+    std::string error() const {
+        return std::string(errorMessage ? errorMessage : "No error") + " in JSON at offset " + std::to_string(errorOffset);
+    }
 
-        if (lines.size() < 2) {
-            throw std::runtime_error("Missing data row in CSV");
+private:
+    std::string_view text;
+    size_t pos = 0;
+    std::string path;
+    std::string scratch;
+    const char* errorMessage = nullptr;
+    size_t errorOffset = 0;
+
+    bool fail(const char* message) {
+        errorMessage = message;
+        errorOffset = pos;
+        return false;
+    }
+
+    void skipWhitespace() {
+        while (pos < text.size() && (text[pos] == ' ' || text[pos] == '\t' || text[pos] == '\n' || text[pos] == '\r')) {
+            ++pos;
         }
+    }
 
-        std::vector<std::string> values;
-        pos = 0;
-        while ((end = lines[1].find(delimiter, pos)) != std::string::npos) {
-            values.push_back(lines[1].substr(pos, end - pos));
-            pos = end + 1;
+    bool expect(char c) {
+        skipWhitespace();
+        if (pos >= text.size() || text[pos] != c) {
+            return fail(c == ':' ? "Missing key-value separator" : "Unexpected character");
         }
-        values.push_back(lines[1].substr(pos));
+        ++pos;
+        return true;
+    }
 
+    static void appendUtf8(std::string& out, uint32_t codePoint) {
+        if (codePoint < 0x80) {
+            out.push_back(static_cast<char>(codePoint));
+        }
+        else if (codePoint < 0x800) {
+            out.push_back(static_cast<char>(0xC0 | (codePoint >> 6)));
+            out.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+        }
+        else if (codePoint < 0x10000) {
+            out.push_back(static_cast<char>(0xE0 | (codePoint >> 12)));
+            out.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+        }
+        else {
+            out.push_back(static_cast<char>(0xF0 | (codePoint >> 18)));
+            out.push_back(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+        }
+    }
 
-        if (headers.size() != values.size()) {
-            throw std::runtime_error("CSV headers and values count mismatch");
+    bool parseHex4(uint32_t& value) {
+        if (pos + 4 > text.size()) {
+            return fail("Truncated \\u escape");
+        }
+        value = 0;
+        for (int i = 0; i < 4; ++i) {
+            char c = text[pos++];
+            value <<= 4;
+            if (c >= '0' && c <= '9') value |= c - '0';
+            else if (c >= 'a' && c <= 'f') value |= c - 'a' + 10;
+            else if (c >= 'A' && c <= 'F') value |= c - 'A' + 10;
+            else return fail("Invalid \\u escape");
         }
+        return true;
+    }
 
+    // Строка без escape-последовательностей возвращается как view во входные данные,
+    // иначе раскодируется в out и возвращается view на дописанную часть.
+    bool parseString(std::string& out, std::string_view& result) {
+        ++pos;
+        const size_t start = pos;
+        while (pos < text.size() && text[pos] != '"' && text[pos] != '\\') {
+            ++pos;
+        }
+        if (pos >= text.size()) {
+            return fail("Unterminated string");
+        }
+        if (text[pos] == '"') {
+            result = text.substr(start, pos++ - start);
+            return true;
+        }
 
-        for (size_t i = 0; i < headers.size(); ++i) {
-            result[headers[i]] = values[i];
+        const size_t outStart = out.size();
+        out.append(text.data() + start, pos - start);
+        while (true) {
+            if (pos >= text.size()) {
+                return fail("Unterminated string");
+            }
+            char c = text[pos++];
+            if (c == '"') {
+                break;
+            }
+            if (c != '\\') {
+                out.push_back(c);
+                continue;
+            }
+            if (pos >= text.size()) {
+                return fail("Unterminated string");
+            }
+            switch (text[pos++]) {
+            case '"': out.push_back('"'); break;
+            case '\\': out.push_back('\\'); break;
+            case '/': out.push_back('/'); break;
+            case 'b': out.push_back('\b'); break;
+            case 'f': out.push_back('\f'); break;
+            case 'n': out.push_back('\n'); break;
+            case 'r': out.push_back('\r'); break;
+            case 't': out.push_back('\t'); break;
+            case 'u': {
+                uint32_t codePoint;
+                if (!parseHex4(codePoint)) {
+                    return false;
+                }
+                if (codePoint >= 0xDC00 && codePoint <= 0xDFFF) {
+                    return fail("Unpaired surrogate");
+                }
+                if (codePoint >= 0xD800 && codePoint <= 0xDBFF) {
+                    if (pos + 1 >= text.size() || text[pos] != '\\' || text[pos + 1] != 'u') {
+                        return fail("Unpaired surrogate");
+                    }
+                    pos += 2;
+                    uint32_t low;
+                    if (!parseHex4(low)) {
+                        return false;
+                    }
+                    if (low < 0xDC00 || low > 0xDFFF) {
+                        return fail("Invalid surrogate pair");
+                    }
+                    codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+                }
+                appendUtf8(out, codePoint);
+                break;
+            }
+            default:
+                return fail("Invalid escape sequence");
+            }
         }
+        result = std::string_view(out).substr(outStart);
+        return true;
+    }
 
-        return result;
+    size_t skipDigits() {
+        const size_t start = pos;
+        while (pos < text.size() && text[pos] >= '0' && text[pos] <= '9') {
+            ++pos;
+        }
+        return pos - start;
     }
 
-    std::string getProcessorType() const override {
-        return "CSV Processor (delimiter: '" + std::string(1, delimiter) + "')";
+    // Ключевые слова true/false/null сравниваются целиком, числа разбираются по
+    // грамматике JSON: -?(0|[1-9]\d*)(\.\d+)?([eE][+-]?\d+)?
+    bool parseLiteral(std::string_view& literal) {
+        const size_t start = pos;
+        for (std::string_view keyword : { std::string_view("true"), std::string_view("false"), std::string_view("null") }) {
+            if (text.compare(pos, keyword.size(), keyword) == 0) {
+                pos += keyword.size();
+                literal = text.substr(start, keyword.size());
+                return true;
+            }
+        }
+
+        if (pos < text.size() && text[pos] == '-') {
+            ++pos;
+        }
+        if (pos >= text.size() || text[pos] < '0' || text[pos] > '9') {
+            return fail(pos == start ? "Unexpected character" : "Invalid number");
+        }
+        if (text[pos] == '0') {
+            ++pos;
+        }
+        else {
+            skipDigits();
+        }
+        if (pos < text.size() && text[pos] == '.') {
+            ++pos;
+            if (skipDigits() == 0) {
+                return fail("Invalid number");
+            }
+        }
+        if (pos < text.size() && (text[pos] == 'e' || text[pos] == 'E')) {
+            ++pos;
+            if (pos < text.size() && (text[pos] == '+' || text[pos] == '-')) {
+                ++pos;
+            }
+            if (skipDigits() == 0) {
+                return fail("Invalid number");
+            }
+        }
+        literal = text.substr(start, pos - start);
+        return true;
+    }
+
+    template <typename OnValue>
+    bool parseValue(OnValue& onValue, size_t depth) {
+        skipWhitespace();
+        if (pos >= text.size()) {
+            return fail("Unexpected end");
+        }
+
+        const char c = text[pos];
+        if (c == '{' || c == '[') {
+            if (depth >= kMaxDepth) {
+                return fail("Nesting too deep");
+            }
+            ++pos;
+            const bool isArray = c == '[';
+            const char close = isArray ? ']' : '}';
+            const size_t pathLength = path.size();
+            size_t index = 0;
+
+            skipWhitespace();
+            if (pos < text.size() && text[pos] == close) {
+                ++pos;
+                return true;
+            }
+
+            while (true) {
+                if (pathLength > 0) {
+                    path.push_back('.');
+                }
+                if (isArray) {
+                    path += std::to_string(index++);
+                }
+                else {
+                    skipWhitespace();
+                    if (pos >= text.size() || text[pos] != '"') {
+                        return fail("Expected string key");
+                    }
+                    const size_t keyStart = path.size();
+                    std::string_view key;
+                    if (!parseString(path, key)) {
+                        return false;
+                    }
+                    if (path.size() == keyStart) {
+                        path.append(key);
+                    }
+                    if (path.size() == keyStart) {
+                        return fail("Empty key");
+                    }
+                    if (!expect(':')) {
+                        return false;
+                    }
+                }
+
+                if (!parseValue(onValue, depth + 1)) {
+                    return false;
+                }
+                path.resize(pathLength);
+
+                skipWhitespace();
+                if (pos < text.size() && text[pos] == ',') {
+                    ++pos;
+                    continue;
+                }
+                return expect(close);
+            }
+        }
+
+        std::string_view value;
+        if (c == '"') {
+            scratch.clear();
+            if (!parseString(scratch, value)) {
+                return false;
+            }
+        }
+        else if (!parseLiteral(value)) {
+            return false;
+        }
+        onValue(std::string_view(path), value);
+        return true;
     }
 };
 
 
 class JSONProcessor : public DataProcessor {
 private:
+    JsonTokenizer tokenizer;
 
-    bool isValidData(const std::string& data) const override {
-        return data.find('{') != std::string::npos &&
-            data.find('}') != std::string::npos &&
-            data.find(':') != std::string::npos;
+    bool isValidData(std::string_view data) const override {
+        return data.find('{') != std::string_view::npos &&
+            data.find('}') != std::string_view::npos &&
+            data.find(':') != std::string_view::npos;
     }
 
 public:
-    std::map<std::string, std::string> process(const std::string& data) override {
-        checkDataNotEmpty(data);
+    template <typename OnValue>
+    void forEachValue(std::string_view data, OnValue&& onValue) {
+        if (!tokenizer.parse(data, onValue)) {
+            throw std::runtime_error(tokenizer.error());
+        }
+    }
+
+    std::unique_ptr<DataProcessor> clone() const override {
+        return std::make_unique<JSONProcessor>();
+    }
+
+    ProcessStatus tryProcess(std::string_view data, ParseContext& context, std::string& message) override {
+        if (data.empty()) {
+            return reject(message, ProcessStatus::InvalidArgument, "Data cannot be empty");
+        }
 
         if (!isValidData(data)) {
-            throw std::runtime_error("Invalid JSON format");
+            return reject(message, ProcessStatus::ParseError, "Invalid JSON format");
         }
 
-        std::map<std::string, std::string> result;
-        size_t start = data.find('{');
-        size_t end = data.find('}');
+        context.reset();
+        bool parsed = tokenizer.parse(data, [&](std::string_view path, std::string_view value) {
+            context.set(path, value);
+        });
+
+        if (!parsed) {
+            return reject(message, ProcessStatus::ParseError, tokenizer.error());
+        }
 
-        if (start == std::string::npos || end == std::string::npos || start >= end) {
-            throw std::runtime_error("Malformed JSON structure");
+        if (context.size() == 0) {
+            return reject(message, ProcessStatus::ParseError, "Empty key or value in JSON");
         }
+        return ProcessStatus::Ok;
+    }
 
-        std::string content = data.substr(start + 1, end - start - 1);
-        size_t colonPos = content.find(':');
+    std::string getProcessorType() const override {
+        return "JSON Processor";
+    }
+};
 
-        if (colonPos == std::string::npos) {
-            throw std::runtime_error("Missing key-value separator in JSON");
+
+enum class XmlEvent {
+    StartElement,
+    EndElement,
+    Attribute,
+    Text,
+    EndDocument,
+    Error
+};
+
+// Потоковый (pull) парсер XML: каждый вызов next() возвращает одно событие.
+// Документ читается один раз слева направо, стек элементов ограничен kMaxDepth,
+// elementPath() возвращает путь текущего элемента вида "user/name".
+// При ошибке возвращается XmlEvent::Error, описание доступно через error().
+class XmlPullParser {
+public:
+    static constexpr size_t kMaxDepth = 256;
+
+    void reset(std::string_view input) {
+        text = input;
+        pos = 0;
+        path.clear();
+        pathLengths.clear();
+        inStartTag = false;
+        popPending = false;
+        errorMessage.clear();
+    }
+
+    XmlEvent next() {
+        if (!errorMessage.empty()) {
+            return XmlEvent::Error;
         }
 
-        std::string key = content.substr(0, colonPos);
-        std::string value = content.substr(colonPos + 1);
+        if (popPending) {
+            popPending = false;
+            path.resize(pathLengths.back());
+            pathLengths.pop_back();
+        }
 
+        if (inStartTag) {
+            skipWhitespace();
+            if (startsWith("/>")) {
+                pos += 2;
+                inStartTag = false;
+                popPending = true;
+                currentName = elementName();
+                return XmlEvent::EndElement;
+            }
+            if (startsWith(">")) {
+                ++pos;
+                inStartTag = false;
+            }
+            else {
+                return readAttribute();
+            }
+        }
 
-        key.erase(std::remove(key.begin(), key.end(), '"'), key.end());
-        key.erase(std::remove(key.begin(), key.end(), ' '), key.end());
-        value.erase(std::remove(value.begin(), value.end(), '"'), value.end());
-        value.erase(std::remove(value.begin(), value.end(), ' '), value.end());
+        while (pos < text.size()) {
+            if (text[pos] != '<') {
+                size_t end = text.find('<', pos);
+                if (end == std::string_view::npos) {
+                    end = text.size();
+                }
+                std::string_view raw = text.substr(pos, end - pos);
+                pos = end;
+                if (raw.find_first_not_of(" \t\r\n") == std::string_view::npos) {
+                    continue;
+                }
+                if (pathLengths.empty()) {
+                    return fail("Text outside root element");
+                }
+                currentName = elementName();
+                if (!decode(raw, currentValue)) {
+                    return XmlEvent::Error;
+                }
+                return XmlEvent::Text;
+            }
+
+            if (startsWith("<!--")) {
+                if (!skipPast("-->", "Unterminated comment")) {
+                    return XmlEvent::Error;
+                }
+            }
+            else if (startsWith("<![CDATA[")) {
+                const size_t start = pos + 9;
+                if (!skipPast("]]>", "Unterminated CDATA section")) {
+                    return XmlEvent::Error;
+                }
+                if (pathLengths.empty()) {
+                    return fail("Text outside root element");
+                }
+                currentName = elementName();
+                currentValue = text.substr(start, pos - 3 - start);
+                return XmlEvent::Text;
+            }
+            else if (startsWith("<?")) {
+                if (!skipPast("?>", "Unterminated processing instruction")) {
+                    return XmlEvent::Error;
+                }
+            }
+            else if (startsWith("<!")) {
+                if (!skipPast(">", "Unterminated declaration")) {
+                    return XmlEvent::Error;
+                }
+            }
+            else if (startsWith("</")) {
+                pos += 2;
+                std::string_view name;
+                if (!readName(name)) {
+                    return XmlEvent::Error;
+                }
+                skipWhitespace();
+                if (pos >= text.size() || text[pos] != '>') {
+                    return fail("Malformed XML tag");
+                }
+                ++pos;
+                if (pathLengths.empty() || name != elementName()) {
+                    errorMessage = "Missing closing tag for: " +
+                        (pathLengths.empty() ? std::string(name) : std::string(elementName()));
+                    return XmlEvent::Error;
+                }
+                currentName = name;
+                popPending = true;
+                return XmlEvent::EndElement;
+            }
+            else {
+                ++pos;
+                std::string_view name;
+                if (!readName(name)) {
+                    return XmlEvent::Error;
+                }
+                if (pathLengths.size() >= kMaxDepth) {
+                    return fail("XML nesting too deep");
+                }
+                pathLengths.push_back(path.size());
+                if (!path.empty()) {
+                    path.push_back('/');
+                }
+                path.append(name);
+                currentName = elementName();
+                inStartTag = true;
+                return XmlEvent::StartElement;
+            }
+        }
 
-        if (key.empty() || value.empty()) {
-            throw std::runtime_error("Empty key or value in JSON");
+        if (!pathLengths.empty()) {
+            errorMessage = "Missing closing tag for: " + std::string(elementName());
+            return XmlEvent::Error;
         }
+        return XmlEvent::EndDocument;
+    }
 
-        result[key] = value;
-        return result;
+    const std::string& error() const {
+        return errorMessage;
     }
 
-    std::string getProcessorType() const override {
-        return "JSON Processor";
+    // Имя элемента или атрибута текущего события
+    std::string_view name() const {
+        return currentName;
     }
-};
 
+    // Текст или значение атрибута; действительно до следующего вызова next()
+    std::string_view value() const {
+        return currentValue;
+    }
+
+    std::string_view elementPath() const {
+        return path;
+    }
+
+    size_t depth() const {
+        return pathLengths.size();
+    }
 
-class XMLProcessor : public DataProcessor {
 private:
+    std::string_view text;
+    size_t pos = 0;
+    std::string path;
+    std::vector<size_t> pathLengths;
+    std::string scratch;
+    std::string_view currentName;
+    std::string_view currentValue;
+    bool inStartTag = false;
+    bool popPending = false;
+    std::string errorMessage;
+
+    XmlEvent fail(const char* message) {
+        errorMessage = std::string(message) + " at offset " + std::to_string(pos);
+        return XmlEvent::Error;
+    }
 
-    bool isValidData(const std::string& data) const override {
-        return data.find('<') != std::string::npos &&
-            data.find('>') != std::string::npos &&
-            data.find("</") != std::string::npos;
+    bool startsWith(std::string_view prefix) const {
+        return text.compare(pos, prefix.size(), prefix) == 0;
     }
 
-public:
-    std::map<std::string, std::string> process(const std::string& data) override {
-        checkDataNotEmpty(data);
+    void skipWhitespace() {
+        while (pos < text.size() && (text[pos] == ' ' || text[pos] == '\t' || text[pos] == '\n' || text[pos] == '\r')) {
+            ++pos;
+        }
+    }
 
-        if (!isValidData(data)) {
-            throw std::runtime_error("Invalid XML format");
+    bool skipPast(std::string_view terminator, const char* message) {
+        size_t end = text.find(terminator, pos);
+        if (end == std::string_view::npos) {
+            fail(message);
+            return false;
         }
+        pos = end + terminator.size();
+        return true;
+    }
 
-        std::map<std::string, std::string> result;
-        size_t startTag = data.find('<');
-        size_t endTag = data.find('>', startTag);
+    std::string_view elementName() const {
+        const size_t start = pathLengths.back() + (pathLengths.back() == 0 ? 0 : 1);
+        return std::string_view(path).substr(start);
+    }
+
+    bool readName(std::string_view& name) {
+        const size_t start = pos;
+        while (pos < text.size()) {
+            char c = text[pos];
+            if (c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '/' || c == '>' || c == '=') {
+                break;
+            }
+            ++pos;
+        }
+        if (pos == start) {
+            fail("Empty tag name");
+            return false;
+        }
+        name = text.substr(start, pos - start);
+        return true;
+    }
+
+    XmlEvent readAttribute() {
+        if (!readName(currentName)) {
+            return XmlEvent::Error;
+        }
+        skipWhitespace();
+        if (pos >= text.size() || text[pos] != '=') {
+            return fail("Missing '=' after attribute name");
+        }
+        ++pos;
+        skipWhitespace();
+        if (pos >= text.size() || (text[pos] != '"' && text[pos] != '\'')) {
+            return fail("Attribute value must be quoted");
+        }
+        const char quote = text[pos++];
+        size_t end = text.find(quote, pos);
+        if (end == std::string_view::npos) {
+            return fail("Unterminated attribute value");
+        }
+        if (!decode(text.substr(pos, end - pos), currentValue)) {
+            return XmlEvent::Error;
+        }
+        pos = end + 1;
+        return XmlEvent::Attribute;
+    }
 
-        if (startTag == std::string::npos || endTag == std::string::npos) {
-            throw std::runtime_error("Malformed XML tag");
+    // Раскодирует сущности (&lt; &#65; ...); без них возвращает view во входные данные.
+    bool decode(std::string_view raw, std::string_view& decoded) {
+        size_t amp = raw.find('&');
+        if (amp == std::string_view::npos) {
+            decoded = raw;
+            return true;
+        }
+
+        scratch.assign(raw.data(), amp);
+        while (amp < raw.size()) {
+            size_t semicolon = raw.find(';', amp);
+            if (semicolon == std::string_view::npos) {
+                fail("Unterminated entity");
+                return false;
+            }
+            std::string_view entity = raw.substr(amp + 1, semicolon - amp - 1);
+            if (entity == "lt") scratch.push_back('<');
+            else if (entity == "gt") scratch.push_back('>');
+            else if (entity == "amp") scratch.push_back('&');
+            else if (entity == "quot") scratch.push_back('"');
+            else if (entity == "apos") scratch.push_back('\'');
+            else if (entity.size() > 1 && entity[0] == '#') {
+                const bool hex = entity[1] == 'x';
+                const char* first = entity.data() + (hex ? 2 : 1);
+                const char* last = entity.data() + entity.size();
+                unsigned long codePoint = 0;
+                auto parsed = std::from_chars(first, last, codePoint, hex ? 16 : 10);
+                // Допустимы только скалярные значения Unicode: без NUL и суррогатов, не выше U+10FFFF
+                if (parsed.ec != std::errc() || parsed.ptr != last || first == last ||
+                    codePoint == 0 || (codePoint >= 0xD800 && codePoint <= 0xDFFF) || codePoint > 0x10FFFF) {
+                    fail("Invalid character reference");
+                    return false;
+                }
+                appendUtf8(codePoint);
+            }
+            else {
+                fail("Unknown entity");
+                return false;
+            }
+
+            size_t nextAmp = raw.find('&', semicolon + 1);
+            if (nextAmp == std::string_view::npos) {
+                nextAmp = raw.size();
+            }
+            scratch.append(raw.data() + semicolon + 1, nextAmp - semicolon - 1);
+            amp = nextAmp;
+        }
+        decoded = scratch;
+        return true;
+    }
+
+    void appendUtf8(unsigned long codePoint) {
+        if (codePoint < 0x80) {
+            scratch.push_back(static_cast<char>(codePoint));
+        }
+        else if (codePoint < 0x800) {
+            scratch.push_back(static_cast<char>(0xC0 | (codePoint >> 6)));
+            scratch.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+        }
+        else if (codePoint < 0x10000) {
+            scratch.push_back(static_cast<char>(0xE0 | (codePoint >> 12)));
+            scratch.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+            scratch.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
         }
+        else {
+            scratch.push_back(static_cast<char>(0xF0 | (codePoint >> 18)));
+            scratch.push_back(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F)));
+            scratch.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+            scratch.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+        }
+    }
+};
+
+
+class XMLProcessor : public DataProcessor {
+private:
+    XmlPullParser parser;
+    std::string attributeKey;
+
+    bool isValidData(std::string_view data) const override {
+        return data.find('<') != std::string_view::npos &&
+            data.find('>') != std::string_view::npos &&
+            data.find("</") != std::string_view::npos;
+    }
 
-        std::string tag = data.substr(startTag + 1, endTag - startTag - 1);
-        size_t endStartTag = data.find("</" + tag + ">");
+public:
+    std::unique_ptr<DataProcessor> clone() const override {
+        return std::make_unique<XMLProcessor>();
+    }
 
-        if (endStartTag == std::string::npos) {
-            throw std::runtime_error("Missing closing tag in XML");
+    ProcessStatus tryProcess(std::string_view data, ParseContext& context, std::string& message) override {
+        if (data.empty()) {
+            return reject(message, ProcessStatus::InvalidArgument, "Data cannot be empty");
         }
 
-        std::string value = data.substr(endTag + 1, endStartTag - endTag - 1);
+        if (!isValidData(data)) {
+            return reject(message, ProcessStatus::ParseError, "Invalid XML format");
+        }
 
-        if (tag.empty() || value.empty()) {
-            throw std::runtime_error("Empty tag or value in XML");
+        context.reset();
+        parser.reset(data);
+        size_t elements = 0;
+        for (XmlEvent event = parser.next(); event != XmlEvent::EndDocument; event = parser.next()) {
+            switch (event) {
+            case XmlEvent::StartElement:
+                ++elements;
+                break;
+            case XmlEvent::Attribute:
+                attributeKey.assign(parser.elementPath());
+                attributeKey.append("/@");
+                attributeKey.append(parser.name());
+                context.set(attributeKey, parser.value());
+                break;
+            case XmlEvent::Text:
+                context.set(parser.elementPath(), parser.value());
+                break;
+            case XmlEvent::Error:
+                return reject(message, ProcessStatus::ParseError, parser.error());
+            default:
+                break;
+            }
         }
 
-        result[tag] = value;
-        return result;
+        if (elements == 0 || context.size() == 0) {
+            return reject(message, ProcessStatus::ParseError, "Empty tag or value in XML");
+        }
+        return ProcessStatus::Ok;
     }
 
     std::string getProcessorType() const override {
@@ -227,7 +1357,148 @@ void testProcessor(DataProcessor& processor, const std::string& testData) {
     }
 }
 
-int main() {
+#if defined(WITH_BENCHMARKS)
+// Корпуса и прогоны режима --bench; общая обвязка — bench/bench_harness.h
+constexpr size_t kDeepXmlLevels = 32;
+
+struct Corpus {
+    std::vector<std::string> records;
+    size_t bytes = 0;
+};
+
+template <typename MakeRecord>
+Corpus makeCorpus(size_t targetBytes, MakeRecord&& makeRecord) {
+    Corpus corpus;
+    while (corpus.bytes < targetBytes) {
+        corpus.records.push_back(makeRecord(corpus.records.size()));
+        corpus.bytes += corpus.records.back().size();
+    }
+    return corpus;
+}
+
+std::string makeCsvHeader(size_t columns) {
+    std::string header;
+    for (size_t i = 0; i < columns; ++i) {
+        header += (i ? ",col" : "col") + std::to_string(i);
+    }
+    return header;
+}
+
+std::string makeCsvRow(size_t columns, size_t n) {
+    std::string row;
+    for (size_t i = 0; i < columns; ++i) {
+        if (i) {
+            row.push_back(',');
+        }
+        switch (i % 4) {
+        case 0: row += std::to_string(n); break;
+        case 1: row += "user" + std::to_string(n); break;
+        case 2: row += "user" + std::to_string(n) + "@example.com"; break;
+        default: row += "42.5"; break;
+        }
+    }
+    return row;
+}
+
+std::string makeFlatJson(size_t n) {
+    const std::string id = std::to_string(n);
+    return R"({"id": )" + id + R"(, "name": "user)" + id + R"(", "age": )" + std::to_string(20 + n % 50) +
+        R"(, "email": "user)" + id + R"(@example.com", "active": true})";
+}
+
+std::string makeNestedJson(size_t n) {
+    const std::string id = std::to_string(n);
+    return R"({"user": {"id": )" + id + R"(, "profile": {"name": "user)" + id +
+        R"(", "address": {"city": "Moscow", "zip": "101000"}}}, "tags": ["admin", "dev"], "score": 42.5})";
+}
+
+std::string makeShallowXml(size_t n) {
+    const std::string id = std::to_string(n);
+    return "<user><id>" + id + "</id><name>user" + id + "</name><age>" + std::to_string(20 + n % 50) +
+        "</age><email>user" + id + "@example.com</email></user>";
+}
+
+std::string makeDeepXml(size_t n) {
+    std::string xml;
+    for (size_t level = 0; level < kDeepXmlLevels; ++level) {
+        xml += "<l" + std::to_string(level) + ">";
+    }
+    xml += "<value>" + std::to_string(n) + "</value>";
+    for (size_t level = kDeepXmlLevels; level-- > 0;) {
+        xml += "</l" + std::to_string(level) + ">";
+    }
+    return xml;
+}
+
+// process() с построением map, process() с переиспользуемым контекстом и processBatch()
+void benchmarkProcessor(const std::string& name, DataProcessor& processor, size_t corpusSize, const Corpus& corpus) {
+    runBenchmark(name + " process(map)", corpusSize, corpus.bytes, corpus.records.size(), [&]() {
+        for (const std::string& record : corpus.records) {
+            processor.process(record);
+        }
+    });
+
+    ParseContext context;
+    runBenchmark(name + " process(context)", corpusSize, corpus.bytes, corpus.records.size(), [&]() {
+        for (const std::string& record : corpus.records) {
+            processor.process(record, context);
+        }
+    });
+
+    const std::vector<std::string_view> views(corpus.records.begin(), corpus.records.end());
+    runBenchmark(name + " processBatch", corpusSize, corpus.bytes, corpus.records.size(), [&]() {
+        processor.processBatch(views);
+    });
+}
+
+void runBenchmarks(size_t limit) {
+    CSVProcessor csvProcessor;
+    JSONProcessor jsonProcessor;
+    XMLProcessor xmlProcessor;
+
+    for (size_t corpusSize : kCorpusSizes) {
+        if (corpusSize > limit) {
+            break;
+        }
+
+        for (size_t columns : { kNarrowColumns, kWideColumns }) {
+            const std::string name = columns == kNarrowColumns ? "CSV narrow" : "CSV wide";
+            const std::string header = makeCsvHeader(columns) + "\n";
+            benchmarkProcessor(name, csvProcessor, corpusSize,
+                makeCorpus(corpusSize, [&](size_t n) { return header + makeCsvRow(columns, n); }));
+
+            std::string stream = header;
+            size_t rows = 0;
+            while (stream.size() < corpusSize) {
+                stream += makeCsvRow(columns, rows++) + "\n";
+            }
+            runBenchmark(name + " processStream", corpusSize, stream.size(), rows, [&]() {
+                std::istringstream input(stream);
+                csvProcessor.processStream(input,
+                    [](const std::vector<std::string_view>&, const std::vector<std::string_view>&) {});
+            });
+        }
+
+        benchmarkProcessor("JSON flat", jsonProcessor, corpusSize, makeCorpus(corpusSize, makeFlatJson));
+        benchmarkProcessor("JSON nested", jsonProcessor, corpusSize, makeCorpus(corpusSize, makeNestedJson));
+        benchmarkProcessor("XML shallow", xmlProcessor, corpusSize, makeCorpus(corpusSize, makeShallowXml));
+        benchmarkProcessor("XML deep", xmlProcessor, corpusSize, makeCorpus(corpusSize, makeDeepXml));
+    }
+}
+#endif
+
+
+int main(int argc, char* argv[]) {
+#if defined(WITH_BENCHMARKS)
+    if (argc > 1 && std::string(argv[1]) == "--bench") {
+        runBenchmarks(argc > 2 ? std::stoull(argv[2]) << 20 : kDefaultBenchLimit);
+        return 0;
+    }
+#else
+    (void)argc;
+    (void)argv;
+#endif
+
     try {
 
         CSVProcessor csvProcessor;
@@ -237,14 +1508,59 @@ int main() {
 
         std::string csvData = "name,age,email\nJohn Doe,30,john@example.com";
         std::string jsonData = R"({"username": "johndoe", "status": "active"})";
+        std::string nestedJsonData = R"({"user": {"name": "John Doe", "roles": ["admin", "dev"]}, "age": 30})";
         std::string xmlData = R"(<user><id>12345</id><role>admin</role></user>)";
 
 
         testProcessor(csvProcessor, csvData);
         testProcessor(jsonProcessor, jsonData);
+        testProcessor(jsonProcessor, nestedJsonData);
         testProcessor(xmlProcessor, xmlData);
 
 
+        std::istringstream csvStream("name,age,email\nJohn Doe,30,john@example.com\n"
+            "Jane Roe,25,jane@example.com\nMax Mustermann,41,max@example.com\n");
+        std::cout << "\nStreaming " << csvProcessor.getProcessorType() << ":" << std::endl;
+        size_t records = csvProcessor.processStream(csvStream,
+            [](const std::vector<std::string_view>& headers, const std::vector<std::string_view>& values) {
+                for (size_t i = 0; i < headers.size(); ++i) {
+                    std::cout << "  " << headers[i] << " => " << values[i] << "\n";
+                }
+                std::cout << "  --\n";
+            });
+        std::cout << "Streamed records: " << records << std::endl;
+
+
+        ParseContext context;
+        const std::string_view jsonRecords[] = {
+            R"({"id": 1, "user": {"name": "John"}})",
+            R"({"id": 2, "user": {"name": "Jane"}})",
+        };
+        std::cout << "\nReusing ParseContext for " << jsonProcessor.getProcessorType() << ":" << std::endl;
+        for (std::string_view record : jsonRecords) {
+            jsonProcessor.process(record, context);
+            context.forEach([](std::string_view key, std::string_view value) {
+                std::cout << "  " << key << " => " << value << "\n";
+            });
+        }
+
+
+        const std::vector<std::string_view> batch = {
+            R"({"id": 1, "status": "active"})",
+            R"({"id": 2, "status": })",
+            R"({"id": 3, "status": "blocked"})",
+        };
+        std::cout << "\nBatch processing with " << jsonProcessor.getProcessorType() << ":" << std::endl;
+        std::vector<BatchResult> results = jsonProcessor.processBatch(batch);
+        for (size_t i = 0; i < results.size(); ++i) {
+            if (results[i].status == ProcessStatus::Ok) {
+                std::cout << "  #" << i << " ok, " << results[i].values.size() << " values\n";
+            }
+            else {
+                std::cout << "  #" << i << " error: " << results[i].message << "\n";
+            }
+        }
+
 
     }
     catch (const std::exception& e) {
@@ -3,13 +3,410 @@
 #include <stdexcept>
 #include <string>
 #include <vector>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
 #include <nlohmann/json.hpp>
 
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(__linux__)
+#include <sys/syscall.h>
+#if __has_include(<linux/io_uring.h>) && defined(__NR_io_uring_setup)
+#include <linux/io_uring.h>
+#define FILE_BATCH_IO_URING
+#endif
+#endif
+
 using json = nlohmann::json;
 
+// Размер и время изменения файла: содержимое в кеше действительно, пока они не изменились
+struct FileStamp {
+    uintmax_t size = 0;
+    std::filesystem::file_time_type modified;
+
+    static bool of(const std::string& path, FileStamp& stamp) {
+        std::error_code error;
+        stamp.size = std::filesystem::file_size(path, error);
+        if (error) {
+            return false;
+        }
+        stamp.modified = std::filesystem::last_write_time(path, error);
+        return !error;
+    }
+
+    bool operator==(const FileStamp& other) const {
+        return size == other.size && modified == other.modified;
+    }
+};
+
+// Общий потокобезопасный кеш прочитанного содержимого: ключ — тип читателя и путь,
+// запись проверяется по размеру и времени изменения файла. Объём ограничен бюджетом
+// в байтах, при превышении вытесняются давно не использованные записи (LRU).
+class ReadCache {
+public:
+    struct Stats {
+        size_t hits = 0;
+        size_t misses = 0;
+        size_t evictions = 0;
+        size_t entries = 0;
+        size_t bytes = 0;
+    };
+
+    static constexpr size_t kDefaultBudget = 64 * 1024 * 1024;
+
+    explicit ReadCache(size_t byteBudget = kDefaultBudget) : budget(byteBudget) {}
+
+    static ReadCache& shared() {
+        static ReadCache cache;
+        return cache;
+    }
+
+    std::shared_ptr<const std::string> find(const std::string& key, const FileStamp& stamp) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto found = index.find(key);
+        if (found == index.end() || !(found->second->stamp == stamp)) {
+            ++stats.misses;
+            return nullptr;
+        }
+        ++stats.hits;
+        entries.splice(entries.begin(), entries, found->second);
+        return found->second->content;
+    }
+
+    void insert(const std::string& key, const FileStamp& stamp, std::shared_ptr<const std::string> content) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto found = index.find(key);
+        if (found != index.end()) {
+            remove(found->second);
+        }
+        if (content->size() > budget) {
+            return;
+        }
+        entries.push_front(Entry{ key, stamp, std::move(content) });
+        index[key] = entries.begin();
+        stats.bytes += entries.front().content->size();
+        ++stats.entries;
+        while (stats.bytes > budget) {
+            remove(std::prev(entries.end()));
+            ++stats.evictions;
+        }
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lock(mutex);
+        entries.clear();
+        index.clear();
+        stats.entries = 0;
+        stats.bytes = 0;
+    }
+
+    Stats getStats() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return stats;
+    }
+
+    size_t getBudget() const {
+        return budget;
+    }
+
+private:
+    struct Entry {
+        std::string key;
+        FileStamp stamp;
+        std::shared_ptr<const std::string> content;
+    };
+
+    size_t budget;
+    mutable std::mutex mutex;
+    std::list<Entry> entries;
+    std::unordered_map<std::string, std::list<Entry>::iterator> index;
+    Stats stats;
+
+    void remove(std::list<Entry>::iterator entry) {
+        stats.bytes -= entry->content->size();
+        --stats.entries;
+        index.erase(entry->key);
+        entries.erase(entry);
+    }
+};
+
+// Файл, отображённый в память только для чтения. Представление view() действительно,
+// пока жив объект FileView; дескриптор закрывается сразу после отображения.
+class FileView {
+public:
+    FileView() = default;
+
+    explicit FileView(const std::string& path) {
+#if defined(_WIN32)
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+            FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            throw std::runtime_error("File not found: " + path);
+        }
+
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize)) {
+            CloseHandle(file);
+            throw std::runtime_error("Failed to get file size: " + path);
+        }
+        size = static_cast<size_t>(fileSize.QuadPart);
+
+        if (size > 0) {
+            HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (mapping != nullptr) {
+                data = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+                CloseHandle(mapping);
+            }
+        }
+        CloseHandle(file);
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("File not found: " + path);
+        }
+
+        struct stat info;
+        if (::fstat(fd, &info) != 0) {
+            ::close(fd);
+            throw std::runtime_error("Failed to get file size: " + path);
+        }
+        size = static_cast<size_t>(info.st_size);
+
+        if (size > 0) {
+            void* address = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (address != MAP_FAILED) {
+                ::madvise(address, size, MADV_SEQUENTIAL);
+                data = static_cast<const char*>(address);
+            }
+        }
+        ::close(fd);
+#endif
+
+        if (size > 0 && data == nullptr) {
+            throw std::runtime_error("Failed to map file: " + path);
+        }
+    }
+
+    FileView(FileView&& other) noexcept : data(other.data), size(other.size) {
+        other.data = nullptr;
+        other.size = 0;
+    }
+
+    FileView& operator=(FileView&& other) noexcept {
+        if (this != &other) {
+            release();
+            data = other.data;
+            size = other.size;
+            other.data = nullptr;
+            other.size = 0;
+        }
+        return *this;
+    }
+
+    FileView(const FileView&) = delete;
+    FileView& operator=(const FileView&) = delete;
+
+    ~FileView() {
+        release();
+    }
+
+    std::string_view view() const {
+        return std::string_view(data, size);
+    }
+
+private:
+    const char* data = nullptr;
+    size_t size = 0;
+
+    void release() {
+        if (data == nullptr) {
+            return;
+        }
+#if defined(_WIN32)
+        UnmapViewOfFile(data);
+#else
+        ::munmap(const_cast<char*>(data), size);
+#endif
+        data = nullptr;
+    }
+};
+
+// Последовательное чтение файла блоками фиксированного размера с упреждением: пока
+// вызывающий обрабатывает текущий блок, следующий читается в фоне одним потоком
+// чтения на объект, блоки передаются через условную переменную. Память ограничена
+// двумя блоками независимо от размера файла. Последний блок может быть короче
+// (короткое чтение у конца файла), после него next() возвращает пустой view.
+class ChunkReader {
+public:
+    static constexpr size_t kDefaultChunkSize = 1024 * 1024;
+
+    explicit ChunkReader(const std::string& path, size_t chunkSize = kDefaultChunkSize)
+        : file(path, std::ios::binary), current(std::max<size_t>(chunkSize, 1)), ahead(current.size()) {
+        if (!file.is_open()) {
+            throw std::runtime_error("File not found: " + path);
+        }
+        worker = std::thread([this]() { readLoop(); });
+    }
+
+    ChunkReader(const ChunkReader&) = delete;
+    ChunkReader& operator=(const ChunkReader&) = delete;
+
+    ~ChunkReader() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        changed.notify_one();
+        worker.join();
+    }
+
+    // Следующий блок; действителен до следующего вызова next()
+    std::string_view next() {
+        if (finished) {
+            return {};
+        }
+
+        std::unique_lock<std::mutex> lock(mutex);
+        changed.wait(lock, [this]() { return aheadReady; });
+        if (readError) {
+            finished = true;
+            std::rethrow_exception(readError);
+        }
+        const size_t length = aheadLength;
+        current.swap(ahead);
+        aheadReady = false;
+        finished = length < current.size();
+        lock.unlock();
+        changed.notify_one();
+
+        chunkOffset = nextOffset;
+        nextOffset += length;
+        return std::string_view(current.data(), length);
+    }
+
+    // Смещение в файле последнего блока, возвращённого next()
+    uint64_t offset() const {
+        return chunkOffset;
+    }
+
+    // Обход блоков в цикле for: for (std::string_view chunk : reader) { ... }
+    class Iterator {
+    public:
+        explicit Iterator(ChunkReader* chunkReader) : reader(chunkReader) {}
+
+        std::string_view operator*() const {
+            return chunk;
+        }
+
+        Iterator& operator++() {
+            chunk = reader->next();
+            if (chunk.empty()) {
+                reader = nullptr;
+            }
+            return *this;
+        }
+
+        bool operator!=(const Iterator& other) const {
+            return reader != other.reader;
+        }
+
+    private:
+        ChunkReader* reader;
+        std::string_view chunk;
+    };
+
+    Iterator begin() {
+        return ++Iterator(this);
+    }
+
+    Iterator end() {
+        return Iterator(nullptr);
+    }
+
+private:
+    std::ifstream file;
+    std::vector<char> current;
+    std::vector<char> ahead;
+    uint64_t chunkOffset = 0;
+    uint64_t nextOffset = 0;
+    bool finished = false;
+
+    // Состояние, общее с потоком чтения: ahead заполнен (aheadReady) или свободен
+    std::mutex mutex;
+    std::condition_variable changed;
+    bool aheadReady = false;
+    bool stopping = false;
+    size_t aheadLength = 0;
+    std::exception_ptr readError;
+    std::thread worker;
+
+    // Поток чтения живёт вместе с объектом: заполняет ahead, ждёт, пока next() его
+    // заберёт, и завершается после короткого блока, ошибки или деструктора.
+    void readLoop() {
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                changed.wait(lock, [this]() { return stopping || !aheadReady; });
+                if (stopping) {
+                    return;
+                }
+            }
+
+            size_t length = 0;
+            std::exception_ptr error;
+            try {
+                file.read(ahead.data(), static_cast<std::streamsize>(ahead.size()));
+                if (file.bad()) {
+                    throw std::runtime_error("Error reading file chunk");
+                }
+                length = static_cast<size_t>(file.gcount());
+            }
+            catch (...) {
+                error = std::current_exception();
+            }
+
+            // После aheadReady буфер ahead принадлежит next(), размер читается до этого
+            const bool last = error || length < ahead.size();
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                aheadLength = length;
+                readError = error;
+                aheadReady = true;
+            }
+            changed.notify_one();
+            if (last) {
+                return;
+            }
+        }
+    }
+};
+
 class FileReader {
 protected:
     std::string filePath;
+    ReadCache* cache = &ReadCache::shared();
 
     void checkFileExists() const {
         std::ifstream file(filePath);
@@ -18,19 +415,109 @@ protected:
         }
     }
 
+    // Чтение и разбор файла без кеша; реализуется в производных классах.
+    virtual std::string load() = 0;
+
+    // Ищет файл в кеше; key остаётся пустым, если кеш отключён или файл не найден.
+    std::shared_ptr<const std::string> findCached(std::string& key, FileStamp& stamp) const {
+        if (!cache || !FileStamp::of(filePath, stamp)) {
+            return nullptr;
+        }
+        std::error_code error;
+        key = getFileType() + '\n' + std::filesystem::absolute(filePath, error).string();
+        return cache->find(key, stamp);
+    }
+
+    bool isCacheable(const std::string& content, const FileStamp& stamp) const {
+        FileStamp after;
+        return content.size() <= cache->getBudget() && FileStamp::of(filePath, after) && after == stamp;
+    }
+
 public:
     explicit FileReader(const std::string& path) : filePath(path) {}
     virtual ~FileReader() = default;
 
-    virtual std::string read() = 0;
+    // Содержимое берётся из кеша, если файл не менялся; иначе читается через load().
+    // Если файл изменился во время чтения или не помещается в бюджет кеша, результат
+    // не кешируется и возвращается без копирования.
+    std::string read() {
+        std::string key;
+        FileStamp stamp;
+        if (auto cached = findCached(key, stamp)) {
+            return *cached;
+        }
+
+        std::string content = load();
+        if (key.empty() || !isCacheable(content, stamp)) {
+            return content;
+        }
+        auto shared = std::make_shared<const std::string>(std::move(content));
+        cache->insert(key, stamp, shared);
+        return *shared;
+    }
+
+    // То же, что read(), но при попадании в кеш содержимое не копируется:
+    // возвращается общий с кешем неизменяемый буфер.
+    std::shared_ptr<const std::string> readShared() {
+        std::string key;
+        FileStamp stamp;
+        if (auto cached = findCached(key, stamp)) {
+            return cached;
+        }
+
+        auto content = std::make_shared<const std::string>(load());
+        if (!key.empty() && isCacheable(*content, stamp)) {
+            cache->insert(key, stamp, content);
+        }
+        return content;
+    }
+
+    // Размер файла в байтах — сколько места нужно буферу для readInto()
+    size_t getFileSize() const {
+        checkFileExists();
+        std::ifstream file(filePath, std::ios::binary | std::ios::ate);
+        return static_cast<size_t>(file.tellg());
+    }
+
+    // Сырые байты файла (без перевода строк и разбора) в буфер вызывающего, без
+    // промежуточных копий и кеша. Возвращает число прочитанных байт.
+    size_t readInto(char* buffer, size_t capacity) const {
+        checkFileExists();
+        std::ifstream file(filePath, std::ios::binary | std::ios::ate);
+        const size_t size = static_cast<size_t>(file.tellg());
+        if (size > capacity) {
+            throw std::runtime_error("Buffer too small for file: " + filePath);
+        }
+        file.seekg(0, std::ios::beg);
+        file.read(buffer, static_cast<std::streamsize>(size));
+        if (static_cast<size_t>(file.gcount()) != size) {
+            throw std::runtime_error("Error reading file: " + filePath);
+        }
+        return size;
+    }
+
+    // Сырые байты файла, отображённые в память: данные действительны, пока жив FileView.
+    FileView map() const {
+        return FileView(filePath);
+    }
+
+    // Сырые байты файла блоками по chunkSize байт с упреждающим чтением, без кеша
+    ChunkReader chunks(size_t chunkSize = ChunkReader::kDefaultChunkSize) const {
+        checkFileExists();
+        return ChunkReader(filePath, chunkSize);
+    }
+
+    // nullptr отключает кеширование для этого читателя
+    void setCache(ReadCache* readCache) {
+        cache = readCache;
+    }
+
     virtual std::string getFileType() const = 0;
 };
 
 class TextFileReader : public FileReader {
-public:
-    explicit TextFileReader(const std::string& path) : FileReader(path) {}
-
-    std::string read() override {
+protected:
+    std::string load() override {
         checkFileExists();
 
         std::ifstream file(filePath);
@@ -38,26 +525,31 @@ public:
             throw std::runtime_error("Failed to open text file: " + filePath);
         }
 
-        std::string content((std::istreambuf_iterator<char>(file)),
-            std::istreambuf_iterator<char>());
+        // Размер на диске — верхняя граница: в текстовом режиме \r\n может сократиться до \n.
+        file.seekg(0, std::ios::end);
+        std::string content(static_cast<size_t>(file.tellg()), '\0');
+        file.seekg(0, std::ios::beg);
+        file.read(&content[0], static_cast<std::streamsize>(content.size()));
 
-        if (file.fail() && !file.eof()) {
+        if (file.bad()) {
             throw std::runtime_error("Error reading text file: " + filePath);
         }
 
+        content.resize(static_cast<size_t>(file.gcount()));
         return content;
     }
 
+public:
+    explicit TextFileReader(const std::string& path) : FileReader(path) {}
+
     std::string getFileType() const override {
         return "Text File";
     }
 };
 
 class BinaryFileReader : public FileReader {
-public:
-    explicit BinaryFileReader(const std::string& path) : FileReader(path) {}
-
-    std::string read() override {
+protected:
+    std::string load() override {
         checkFileExists();
 
         std::ifstream file(filePath, std::ios::binary);
@@ -69,26 +561,27 @@ public:
         size_t size = file.tellg();
         file.seekg(0, std::ios::beg);
 
-        std::vector<char> buffer(size);
-        file.read(buffer.data(), size);
+        std::string content(size, '\0');
+        file.read(&content[0], static_cast<std::streamsize>(size));
 
         if (file.fail() && !file.eof()) {
             throw std::runtime_error("Error reading binary file: " + filePath);
         }
 
-        return std::string(buffer.begin(), buffer.end());
+        return content;
     }
 
+public:
+    explicit BinaryFileReader(const std::string& path) : FileReader(path) {}
+
     std::string getFileType() const override {
         return "Binary File";
     }
 };
 
 class JsonFileReader : public FileReader {
-public:
-    explicit JsonFileReader(const std::string& path) : FileReader(path) {}
-
-    std::string read() override {
+protected:
+    std::string load() override {
         checkFileExists();
 
         std::ifstream file(filePath);
@@ -111,11 +604,545 @@ public:
         return j.dump(4); 
     }
 
+public:
+    // Посетитель записи NDJSON: разобранная запись и смещение её строки в файле
+    using RecordVisitor = std::function<void(const json& record, size_t offset)>;
+
+    explicit JsonFileReader(const std::string& path) : FileReader(path) {}
+
+    // Режим NDJSON (JSON Lines): одна запись на строку, пустые строки пропускаются.
+    // Файл отображается в память и делится по переводам строк на фрагменты, которые
+    // разбираются параллельно; каждая запись передаётся в visitor без форматирования.
+    // visitor вызывается одновременно из нескольких потоков, внутри фрагмента — по порядку.
+    // Первая ошибка разбора останавливает чтение и пробрасывается. Возвращает число записей.
+    size_t readNdjson(const RecordVisitor& visitor, unsigned threads = std::thread::hardware_concurrency()) const {
+        static constexpr size_t kMinChunkSize = 256 * 1024;
+
+        checkFileExists();
+        FileView mapped = map();
+        const std::string_view text = mapped.view();
+        const size_t workerCount = std::max<size_t>(1, std::min<size_t>(threads, text.size() / kMinChunkSize));
+        // Фрагментов больше, чем потоков, чтобы длинные записи не оставляли потоки без работы
+        const size_t chunkCount = workerCount == 1 ? 1 : workerCount * 4;
+
+        std::vector<size_t> boundaries(chunkCount + 1, text.size());
+        boundaries[0] = 0;
+        for (size_t i = 1; i < chunkCount; ++i) {
+            const size_t newline = text.find('\n', std::max(boundaries[i - 1], text.size() / chunkCount * i));
+            boundaries[i] = newline == std::string_view::npos ? text.size() : newline + 1;
+        }
+
+        std::atomic<size_t> nextChunk{ 0 };
+        std::atomic<size_t> records{ 0 };
+        std::atomic<bool> failed{ false };
+        std::mutex errorMutex;
+        std::exception_ptr error;
+
+        auto work = [&]() {
+            try {
+                for (size_t chunk = nextChunk++; chunk < chunkCount && !failed; chunk = nextChunk++) {
+                    size_t pos = boundaries[chunk];
+                    size_t count = 0;
+                    while (pos < boundaries[chunk + 1] && !failed) {
+                        size_t end = text.find('\n', pos);
+                        if (end == std::string_view::npos || end > boundaries[chunk + 1]) {
+                            end = boundaries[chunk + 1];
+                        }
+                        std::string_view line = text.substr(pos, end - pos);
+                        const size_t offset = pos;
+                        pos = end + 1;
+                        if (line.find_first_not_of(" \t\r") == std::string_view::npos) {
+                            continue;
+                        }
+                        json record;
+                        try {
+                            record = json::parse(line.begin(), line.end());
+                        }
+                        catch (const json::parse_error& e) {
+                            throw std::runtime_error("NDJSON parse error at offset " + std::to_string(offset) +
+                                ": " + std::string(e.what()));
+                        }
+                        visitor(record, offset);
+                        ++count;
+                    }
+                    records += count;
+                }
+            }
+            catch (...) {
+                std::lock_guard<std::mutex> lock(errorMutex);
+                if (!error) {
+                    error = std::current_exception();
+                }
+                failed = true;
+            }
+        };
+
+        std::vector<std::thread> workers;
+        for (size_t i = 1; i < workerCount; ++i) {
+            workers.emplace_back(work);
+        }
+        work();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+        return records;
+    }
+
     std::string getFileType() const override {
         return "JSON File";
     }
 };
 
+// Результат чтения одного файла пакета
+struct BatchReadResult {
+    size_t index = 0;        // номер пути в переданном списке
+    std::string content;
+    std::string error;       // пусто при успешном чтении
+};
+
+// Пакетное чтение множества файлов целиком (сырые байты). На Linux открытия, чтения
+// и закрытия отправляются пачками через io_uring: до queueDepth файлов одновременно
+// в очереди, один системный вызов на пачку. Если io_uring недоступен (старое ядро,
+// запрет seccomp, другая ОС), используется пул потоков с pread. Результаты передаются
+// в onComplete по мере готовности в произвольном порядке; вызовы не пересекаются.
+class BatchFileReader {
+public:
+    enum class Backend {
+        IoUring,
+        ThreadPool
+    };
+
+    using Completion = std::function<void(BatchReadResult&)>;
+
+    explicit BatchFileReader(Backend preferred = Backend::IoUring,
+        unsigned threads = std::thread::hardware_concurrency(), unsigned depth = 256)
+        : threadCount(threads == 0 ? 1 : threads), queueDepth(depth == 0 ? 1 : depth) {
+#if defined(FILE_BATCH_IO_URING)
+        if (preferred == Backend::IoUring) {
+            ring = std::make_unique<Ring>();
+            if (!ring->setup(queueDepth)) {
+                ring.reset();
+            }
+        }
+#else
+        (void)preferred;
+#endif
+    }
+
+    Backend getBackend() const {
+#if defined(FILE_BATCH_IO_URING)
+        if (ring) {
+            return Backend::IoUring;
+        }
+#endif
+        return Backend::ThreadPool;
+    }
+
+    // Читает все файлы; возвращает число успешно прочитанных.
+    size_t readAll(const std::vector<std::string>& paths, const Completion& onComplete) {
+#if defined(FILE_BATCH_IO_URING)
+        if (ring) {
+            return readWithRing(paths, onComplete);
+        }
+#endif
+        return readWithPool(paths, onComplete);
+    }
+
+private:
+    unsigned threadCount;
+    unsigned queueDepth;
+
+    static bool readWholeFile(const std::string& path, std::string& content, std::string& error) {
+#if defined(_WIN32)
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file.is_open()) {
+            error = "File not found: " + path;
+            return false;
+        }
+        content.resize(static_cast<size_t>(file.tellg()));
+        file.seekg(0, std::ios::beg);
+        file.read(&content[0], static_cast<std::streamsize>(content.size()));
+        content.resize(static_cast<size_t>(file.gcount()));
+        return true;
+#else
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            error = "Failed to open " + path + ": " + std::strerror(errno);
+            return false;
+        }
+        struct stat info;
+        content.resize(::fstat(fd, &info) == 0 ? static_cast<size_t>(info.st_size) + 1 : 4096);
+        size_t length = 0;
+        while (true) {
+            if (length == content.size()) {
+                content.resize(content.size() * 2);
+            }
+            const ssize_t got = ::pread(fd, &content[length], content.size() - length, static_cast<off_t>(length));
+            if (got < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                error = "Failed to read " + path + ": " + std::strerror(errno);
+                ::close(fd);
+                return false;
+            }
+            if (got == 0) {
+                break;
+            }
+            length += static_cast<size_t>(got);
+        }
+        ::close(fd);
+        content.resize(length);
+        return true;
+#endif
+    }
+
+    size_t readWithPool(const std::vector<std::string>& paths, const Completion& onComplete) {
+        std::atomic<size_t> next{ 0 };
+        std::atomic<size_t> succeeded{ 0 };
+        std::mutex completionMutex;
+        std::exception_ptr callbackError;
+
+        auto work = [&]() {
+            BatchReadResult result;
+            for (size_t index = next++; index < paths.size(); index = next++) {
+                result.index = index;
+                result.error.clear();
+                if (readWholeFile(paths[index], result.content, result.error)) {
+                    ++succeeded;
+                }
+                std::lock_guard<std::mutex> lock(completionMutex);
+                if (callbackError) {
+                    return;
+                }
+                try {
+                    onComplete(result);
+                }
+                catch (...) {
+                    callbackError = std::current_exception();
+                    next = paths.size();
+                    return;
+                }
+            }
+        };
+
+        const size_t workerCount = std::min<size_t>(threadCount, paths.size());
+        std::vector<std::thread> workers;
+        for (size_t i = 1; i < workerCount; ++i) {
+            workers.emplace_back(work);
+        }
+        work();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        if (callbackError) {
+            std::rethrow_exception(callbackError);
+        }
+        return succeeded;
+    }
+
+#if defined(FILE_BATCH_IO_URING)
+    // Минимальная обёртка над системными вызовами io_uring без liburing:
+    // кольца отправки и завершения отображаются в память процесса.
+    class Ring {
+    public:
+        Ring() = default;
+        Ring(const Ring&) = delete;
+        Ring& operator=(const Ring&) = delete;
+
+        ~Ring() {
+            if (sqes != nullptr) {
+                ::munmap(sqes, sqeBytes);
+            }
+            if (cqRing != nullptr && cqRing != sqRing) {
+                ::munmap(cqRing, cqBytes);
+            }
+            if (sqRing != nullptr) {
+                ::munmap(sqRing, sqBytes);
+            }
+            if (fd >= 0) {
+                ::close(fd);
+            }
+        }
+
+        bool setup(unsigned entries) {
+            io_uring_params params{};
+            fd = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &params));
+            if (fd < 0) {
+                return false;
+            }
+
+            sqBytes = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+            cqBytes = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+            const bool singleMmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+            if (singleMmap) {
+                sqBytes = cqBytes = std::max(sqBytes, cqBytes);
+            }
+
+            sqRing = mapRing(sqBytes, IORING_OFF_SQ_RING);
+            if (sqRing == nullptr) {
+                return false;
+            }
+            cqRing = singleMmap ? sqRing : mapRing(cqBytes, IORING_OFF_CQ_RING);
+            if (cqRing == nullptr) {
+                return false;
+            }
+            sqeBytes = params.sq_entries * sizeof(io_uring_sqe);
+            sqes = static_cast<io_uring_sqe*>(mapRing(sqeBytes, IORING_OFF_SQES));
+            if (sqes == nullptr) {
+                return false;
+            }
+
+            char* sq = static_cast<char*>(sqRing);
+            sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+            sqMask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+            sqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+            char* cq = static_cast<char*>(cqRing);
+            cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+            cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+            cqMask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+            cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+            return supportsOperations();
+        }
+
+        // Следующая свободная запись очереди отправки; видна ядру после submitAndWait().
+        io_uring_sqe& prepare(uint8_t opcode, int fileDescriptor, uint64_t userData) {
+            const unsigned tail = *sqTail + queued;
+            io_uring_sqe& sqe = sqes[tail & sqMask];
+            std::memset(&sqe, 0, sizeof(sqe));
+            sqe.opcode = opcode;
+            sqe.fd = fileDescriptor;
+            sqe.user_data = userData;
+            sqArray[tail & sqMask] = tail & sqMask;
+            ++queued;
+            return sqe;
+        }
+
+        // Отправляет подготовленные записи и ждёт хотя бы одно завершение.
+        bool submitAndWait() {
+            __atomic_store_n(sqTail, *sqTail + queued, __ATOMIC_RELEASE);
+            const unsigned toSubmit = queued;
+            queued = 0;
+            while (true) {
+                const long result = ::syscall(__NR_io_uring_enter, fd, toSubmit, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+                if (result >= 0) {
+                    return true;
+                }
+                if (errno != EINTR) {
+                    return false;
+                }
+            }
+        }
+
+        template <typename OnCompletion>
+        void reap(OnCompletion&& onCompletion) {
+            unsigned head = *cqHead;
+            const unsigned tail = __atomic_load_n(cqTail, __ATOMIC_ACQUIRE);
+            while (head != tail) {
+                const io_uring_cqe& cqe = cqes[head & cqMask];
+                onCompletion(cqe.user_data, cqe.res);
+                ++head;
+            }
+            __atomic_store_n(cqHead, head, __ATOMIC_RELEASE);
+        }
+
+    private:
+        int fd = -1;
+        void* sqRing = nullptr;
+        void* cqRing = nullptr;
+        io_uring_sqe* sqes = nullptr;
+        size_t sqBytes = 0;
+        size_t cqBytes = 0;
+        size_t sqeBytes = 0;
+        unsigned* sqTail = nullptr;
+        unsigned* sqArray = nullptr;
+        unsigned sqMask = 0;
+        unsigned* cqHead = nullptr;
+        unsigned* cqTail = nullptr;
+        unsigned cqMask = 0;
+        io_uring_cqe* cqes = nullptr;
+        unsigned queued = 0;
+
+        // Кольцо создаётся и на ядрах 5.1-5.5, но OPENAT, READ и CLOSE там нет:
+        // каждая операция завершилась бы с -EINVAL. Список опкодов (IORING_REGISTER_PROBE)
+        // появился в том же 5.6, поэтому ошибка самого запроса тоже означает «не поддерживается».
+        bool supportsOperations() const {
+            static constexpr unsigned kProbeOps = 256;
+            std::vector<uint32_t> storage((sizeof(io_uring_probe) + kProbeOps * sizeof(io_uring_probe_op)) / sizeof(uint32_t) + 1, 0);
+            auto* probe = reinterpret_cast<io_uring_probe*>(storage.data());
+            if (::syscall(__NR_io_uring_register, fd, IORING_REGISTER_PROBE, probe, kProbeOps) < 0) {
+                return false;
+            }
+            for (uint8_t opcode : { IORING_OP_OPENAT, IORING_OP_READ, IORING_OP_CLOSE }) {
+                if (opcode > probe->last_op || (probe->ops[opcode].flags & IO_URING_OP_SUPPORTED) == 0) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        void* mapRing(size_t bytes, off_t offset) const {
+            void* address = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, offset);
+            return address == MAP_FAILED ? nullptr : address;
+        }
+    };
+
+    std::unique_ptr<Ring> ring;
+
+    // Каждый файл проходит этапы открытие -> чтение (повторяется, пока буфер заполняется
+    // целиком) -> закрытие; на слот всегда не больше одной операции в очереди.
+    size_t readWithRing(const std::vector<std::string>& paths, const Completion& onComplete) {
+        static constexpr size_t kInitialBuffer = 16 * 1024;
+
+        enum class Stage { Opening, Reading, Closing };
+        struct Slot {
+            Stage stage = Stage::Opening;
+            int fd = -1;
+            size_t length = 0;
+            BatchReadResult result;
+        };
+
+        // Слоты живут в куче: если очередь не удаётся дождаться, они намеренно
+        // не освобождаются, ядро ещё может писать в буферы незавершённых чтений.
+        auto slotStorage = std::make_unique<std::vector<Slot>>(queueDepth);
+        std::vector<Slot>& slots = *slotStorage;
+        std::vector<uint32_t> freeSlots;
+        for (uint32_t i = queueDepth; i > 0; --i) {
+            freeSlots.push_back(i - 1);
+        }
+
+        auto queueRead = [&](uint32_t id) {
+            Slot& slot = slots[id];
+            if (slot.length == slot.result.content.size()) {
+                slot.result.content.resize(std::max(kInitialBuffer, slot.result.content.size() * 2));
+            }
+            io_uring_sqe& sqe = ring->prepare(IORING_OP_READ, slot.fd, id);
+            sqe.addr = reinterpret_cast<uint64_t>(&slot.result.content[slot.length]);
+            sqe.len = static_cast<uint32_t>(std::min<size_t>(slot.result.content.size() - slot.length, 1u << 30));
+            sqe.off = slot.length;
+        };
+        auto queueClose = [&](uint32_t id) {
+            slots[id].stage = Stage::Closing;
+            ring->prepare(IORING_OP_CLOSE, slots[id].fd, id);
+        };
+
+        size_t next = 0;
+        size_t active = 0;
+        size_t succeeded = 0;
+        std::vector<uint32_t> finished;
+        std::exception_ptr callbackError;
+        try {
+            while (next < paths.size() || active > 0) {
+                while (!freeSlots.empty() && next < paths.size()) {
+                    const uint32_t id = freeSlots.back();
+                    freeSlots.pop_back();
+                    Slot& slot = slots[id];
+                    slot.stage = Stage::Opening;
+                    slot.fd = -1;
+                    slot.length = 0;
+                    slot.result.index = next;
+                    slot.result.content.clear();
+                    slot.result.error.clear();
+                    io_uring_sqe& sqe = ring->prepare(IORING_OP_OPENAT, AT_FDCWD, id);
+                    sqe.addr = reinterpret_cast<uint64_t>(paths[next].c_str());
+                    sqe.open_flags = O_RDONLY | O_CLOEXEC;
+                    ++next;
+                    ++active;
+                }
+
+                if (!ring->submitAndWait()) {
+                    throw std::runtime_error(std::string("io_uring_enter failed: ") + std::strerror(errno));
+                }
+
+                ring->reap([&](uint64_t userData, int res) {
+                    const uint32_t id = static_cast<uint32_t>(userData);
+                    Slot& slot = slots[id];
+                    const std::string& path = paths[slot.result.index];
+                    switch (slot.stage) {
+                    case Stage::Opening:
+                        if (res < 0) {
+                            slot.result.error = "Failed to open " + path + ": " + std::strerror(-res);
+                            finished.push_back(id);
+                            return;
+                        }
+                        slot.fd = res;
+                        slot.stage = Stage::Reading;
+                        if (callbackError) {
+                            queueClose(id);
+                        }
+                        else {
+                            queueRead(id);
+                        }
+                        return;
+                    case Stage::Reading: {
+                        if (res < 0) {
+                            slot.result.error = "Failed to read " + path + ": " + std::strerror(-res);
+                            queueClose(id);
+                            return;
+                        }
+                        const size_t requested = std::min<size_t>(slot.result.content.size() - slot.length, 1u << 30);
+                        slot.length += static_cast<size_t>(res);
+                        if (res > 0 && static_cast<size_t>(res) == requested && !callbackError) {
+                            queueRead(id);
+                        }
+                        else {
+                            queueClose(id);
+                        }
+                        return;
+                    }
+                    case Stage::Closing:
+                        finished.push_back(id);
+                        return;
+                    }
+                });
+
+                for (uint32_t id : finished) {
+                    Slot& slot = slots[id];
+                    slot.result.content.resize(slot.length);
+                    if (slot.result.error.empty()) {
+                        ++succeeded;
+                    }
+                    freeSlots.push_back(id);
+                    --active;
+                    if (callbackError) {
+                        continue;
+                    }
+                    // Как в readWithPool: после ошибки обработчика новые файлы не открываются,
+                    // уже открытые закрываются без дочитывания, очередь опустошается.
+                    try {
+                        onComplete(slot.result);
+                    }
+                    catch (...) {
+                        callbackError = std::current_exception();
+                        next = paths.size();
+                    }
+                }
+                finished.clear();
+            }
+        }
+        catch (...) {
+            // Очередь не дождаться: открытые файлы закрываются, кольцо разрушается
+            // вместе с неотправленными записями, следующие вызовы идут через пул потоков.
+            for (const Slot& slot : slots) {
+                if (slot.stage == Stage::Reading && slot.fd >= 0) {
+                    ::close(slot.fd);
+                }
+            }
+            ring.reset();
+            slotStorage.release();
+            throw;
+        }
+        if (callbackError) {
+            std::rethrow_exception(callbackError);
+        }
+        return succeeded;
+    }
+#endif
+};
+
 void testFileReader(FileReader& reader) {
     try {
         std::cout << "Reading " << reader.getFileType() << " at " << reader.read() << std::endl;
@@ -127,7 +1154,118 @@ void testFileReader(FileReader& reader) {
     }
 }
 
-int main() {
+// Каталог из fileCount небольших файлов (0.5-4 КБ): поштучное чтение TextFileReader и
+// BinaryFileReader против BatchFileReader с пулом pread и с io_uring.
+void benchmarkBatchReading(size_t fileCount) {
+    const std::filesystem::path directory = "bench_files";
+    std::filesystem::create_directories(directory);
+    std::vector<std::string> paths;
+    paths.reserve(fileCount);
+    std::string data;
+    for (size_t i = 0; i < fileCount; ++i) {
+        data.assign(512 + (i * 7919) % 3584, static_cast<char>('a' + i % 26));
+        paths.push_back((directory / ("file" + std::to_string(i) + ".bin")).string());
+        std::ofstream(paths.back(), std::ios::binary).write(data.data(), static_cast<std::streamsize>(data.size()));
+    }
+
+    auto measure = [&](const std::string& name, auto&& run) {
+        auto start = std::chrono::steady_clock::now();
+        const size_t bytes = run();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << name << ": " << static_cast<size_t>(fileCount / elapsed.count()) << " files/s, "
+            << bytes / elapsed.count() / (1024 * 1024) << " MB/s" << std::endl;
+    };
+
+    auto readEach = [&](auto makeReader) {
+        size_t bytes = 0;
+        for (const auto& path : paths) {
+            auto reader = makeReader(path);
+            reader.setCache(nullptr);
+            bytes += reader.read().size();
+        }
+        return bytes;
+    };
+    measure("TextFileReader::read", [&]() {
+        return readEach([](const std::string& path) { return TextFileReader(path); });
+    });
+    measure("BinaryFileReader::read", [&]() {
+        return readEach([](const std::string& path) { return BinaryFileReader(path); });
+    });
+
+    for (auto backend : { BatchFileReader::Backend::ThreadPool, BatchFileReader::Backend::IoUring }) {
+        BatchFileReader batchReader(backend);
+        const bool isRing = batchReader.getBackend() == BatchFileReader::Backend::IoUring;
+        if (backend == BatchFileReader::Backend::IoUring && !isRing) {
+            std::cout << "BatchFileReader (io_uring): unavailable" << std::endl;
+            continue;
+        }
+        measure(isRing ? "BatchFileReader (io_uring)" : "BatchFileReader (pread pool)", [&]() {
+            size_t bytes = 0;
+            batchReader.readAll(paths, [&](BatchReadResult& result) {
+                bytes += result.content.size();
+            });
+            return bytes;
+        });
+    }
+
+    std::error_code error;
+    std::filesystem::remove_all(directory, error);
+}
+
+// Те же записи в виде JSON-массива и в виде NDJSON: разбор целого файла через read()
+// против readNdjson() в одном и во всех потоках, записей в секунду.
+void benchmarkNdjson(size_t recordCount) {
+    const std::string arrayFile = "bench_records.json";
+    const std::string ndjsonFile = "bench_records.ndjson";
+    {
+        std::ofstream array(arrayFile, std::ios::binary);
+        std::ofstream lines(ndjsonFile, std::ios::binary);
+        array << "[";
+        for (size_t i = 0; i < recordCount; ++i) {
+            const std::string record = "{\"id\":" + std::to_string(i) + ",\"user\":\"user" + std::to_string(i % 1000) +
+                "\",\"event\":\"click\",\"value\":" + std::to_string(i % 97) + ".5,\"tags\":[\"a\",\"b\"]}";
+            array << (i ? ",\n" : "\n") << record;
+            lines << record << "\n";
+        }
+        array << "\n]\n";
+    }
+
+    auto measure = [&](const std::string& name, auto&& run) {
+        auto start = std::chrono::steady_clock::now();
+        run();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << name << ": " << static_cast<size_t>(recordCount / elapsed.count()) << " records/s" << std::endl;
+    };
+
+    JsonFileReader wholeReader(arrayFile);
+    wholeReader.setCache(nullptr);
+    measure("JsonFileReader::read (whole file)", [&]() {
+        wholeReader.read();
+    });
+
+    JsonFileReader ndjsonReader(ndjsonFile);
+    std::atomic<size_t> ids{ 0 };
+    auto visitor = [&](const json& record, size_t) {
+        ids += record["id"].get<size_t>();
+    };
+    measure("JsonFileReader::readNdjson (1 thread)", [&]() {
+        ndjsonReader.readNdjson(visitor, 1);
+    });
+    measure("JsonFileReader::readNdjson (all threads)", [&]() {
+        ndjsonReader.readNdjson(visitor);
+    });
+
+    std::remove(arrayFile.c_str());
+    std::remove(ndjsonFile.c_str());
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1 && std::string(argv[1]) == "--bench") {
+        benchmarkBatchReading(argc > 2 ? std::stoull(argv[2]) : 100000);
+        benchmarkNdjson(argc > 3 ? std::stoull(argv[3]) : 1000000);
+        return 0;
+    }
+
     try {
         TextFileReader textReader("example.txt");
         BinaryFileReader binaryReader("example.bin");
@@ -137,6 +1275,49 @@ int main() {
         testFileReader(binaryReader);
         testFileReader(jsonReader);
 
+        std::vector<char> buffer(binaryReader.getFileSize());
+        size_t bytes = binaryReader.readInto(buffer.data(), buffer.size());
+        std::cout << "Read " << bytes << " bytes into caller buffer" << std::endl;
+
+        FileView mapped = textReader.map();
+        std::cout << "Mapped " << mapped.view().size() << " bytes: " << mapped.view() << std::endl;
+
+        size_t chunkCount = 0;
+        size_t chunkBytes = 0;
+        for (std::string_view chunk : jsonReader.chunks(4)) {
+            ++chunkCount;
+            chunkBytes += chunk.size();
+        }
+        std::cout << "Read " << chunkBytes << " bytes in " << chunkCount << " chunks" << std::endl;
+
+        {
+            std::ofstream events("example.ndjson", std::ios::binary);
+            events << "{\"id\":1,\"event\":\"login\"}\n\n{\"id\":2,\"event\":\"click\"}\n{\"id\":3,\"event\":\"logout\"}\n";
+        }
+        std::mutex printMutex;
+        size_t records = JsonFileReader("example.ndjson").readNdjson([&](const json& record, size_t offset) {
+            std::lock_guard<std::mutex> lock(printMutex);
+            std::cout << "NDJSON record at " << offset << ": " << record.dump() << std::endl;
+        });
+        std::cout << "Read " << records << " NDJSON records" << std::endl;
+
+        std::vector<std::string> batch = { "example.txt", "example.bin", "example.json", "missing.txt" };
+        BatchFileReader batchReader;
+        size_t batchRead = batchReader.readAll(batch, [&](BatchReadResult& result) {
+            if (result.error.empty()) {
+                std::cout << "Batch read " << batch[result.index] << ": " << result.content.size() << " bytes" << std::endl;
+            }
+            else {
+                std::cout << "Batch read failed: " << result.error << std::endl;
+            }
+        });
+        std::cout << batchRead << " of " << batch.size() << " files read via "
+            << (batchReader.getBackend() == BatchFileReader::Backend::IoUring ? "io_uring" : "pread pool") << std::endl;
+
+        ReadCache::Stats stats = ReadCache::shared().getStats();
+        std::cout << "Read cache: " << stats.hits << " hits, " << stats.misses << " misses, "
+            << stats.evictions << " evictions, " << stats.entries << " entries, " << stats.bytes << " bytes" << std::endl;
+
     }
     catch (const std::exception& e) {
         std::cerr << "Initialization error: " << e.what() << std::endl;
@@ -1,7 +1,15 @@
 ﻿#include <iostream>
+#include <algorithm>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <random>
 #include <regex>
+#include <thread>
+#include <vector>
 
 class DataValidator {
 public:
@@ -9,26 +17,86 @@ public:
 
     virtual void validate(const std::string& data) const = 0;
 
+    // Проверка без исключений: nullptr, если значение корректно, иначе причина отказа —
+    // строковый литерал, общий для всех значений с той же ошибкой.
+    virtual const char* check(std::string_view data) const noexcept = 0;
+
     virtual std::string getValidatorType() const = 0;
 };
 
+// Детерминированный конечный автомат: символы сводятся к классам по таблице из 256
+// элементов, переход — одно обращение к таблице состояний. Состояние 0 — отказ.
+template <size_t StateCount, size_t ClassCount>
+struct Dfa {
+    std::array<uint8_t, 256> classOf;
+    std::array<std::array<uint8_t, ClassCount>, StateCount> next;
+    std::array<bool, StateCount> accepting;
+
+    bool matches(std::string_view text) const {
+        uint8_t state = 1;
+        for (char c : text) {
+            state = next[state][classOf[static_cast<unsigned char>(c)]];
+            if (state == 0) {
+                return false;
+            }
+        }
+        return accepting[state];
+    }
+};
+
 class EmailValidator : public DataValidator {
 private:
-    const std::regex emailRegex{
-        R"((\w+)(\.|_)?(\w*)@(\w+)(\.(\w+))+)"
-    };
+    // Тот же язык, что и у (\w+)(\.|_)?(\w*)@(\w+)(\.(\w+))+ :
+    // локальная часть \w+ с необязательной точкой и \w* после неё, домен — не меньше
+    // двух непустых меток \w+ через точку.
+    enum CharClass : uint8_t { Other, Word, Dot, At, ClassCount };
+    enum State : uint8_t { Reject, Start, Local, LocalAfterDot, DomainStart, Label, LabelStart, LastLabel, StateCount };
+
+    static constexpr Dfa<StateCount, ClassCount> makeDfa() {
+        Dfa<StateCount, ClassCount> dfa{};
+        for (int c = 0; c < 256; ++c) {
+            const bool word = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+            dfa.classOf[c] = word ? Word : c == '.' ? Dot : c == '@' ? At : Other;
+        }
+        dfa.next[Start][Word] = Local;
+        dfa.next[Local][Word] = Local;
+        dfa.next[Local][Dot] = LocalAfterDot;
+        dfa.next[Local][At] = DomainStart;
+        dfa.next[LocalAfterDot][Word] = LocalAfterDot;
+        dfa.next[LocalAfterDot][At] = DomainStart;
+        dfa.next[DomainStart][Word] = Label;
+        dfa.next[Label][Word] = Label;
+        dfa.next[Label][Dot] = LabelStart;
+        dfa.next[LabelStart][Word] = LastLabel;
+        dfa.next[LastLabel][Word] = LastLabel;
+        dfa.next[LastLabel][Dot] = LabelStart;
+        dfa.accepting[LastLabel] = true;
+        return dfa;
+    }
 
 public:
+    static bool matches(std::string_view email) {
+        static constexpr Dfa<StateCount, ClassCount> dfa = makeDfa();
+        return dfa.matches(email);
+    }
+
     void validate(const std::string& email) const override {
         if (email.empty()) {
             throw std::invalid_argument("Email cannot be empty");
         }
 
-        if (!std::regex_match(email, emailRegex)) {
+        if (!matches(email)) {
             throw std::invalid_argument("Invalid email format: " + email);
         }
     }
 
+    const char* check(std::string_view email) const noexcept override {
+        if (email.empty()) {
+            return "Email cannot be empty";
+        }
+        return matches(email) ? nullptr : "Invalid email format";
+    }
+
     std::string getValidatorType() const override {
         return "Email Validator";
     }
@@ -36,21 +104,80 @@ public:
 
 class PhoneValidator : public DataValidator {
 private:
-    const std::regex phoneRegex{
-        R"(^\+?(\d[\d-. ]+)?(\([\d-. ]+\))?[\d-. ]+\d$)"
+    // Тот же язык, что и у ^\+?(\d[\d-. ]+)?(\([\d-. ]+\))?[\d-. ]+\d$ , где [\d-. ] —
+    // цифра, дефис, точка или пробел. Без скобок: необязательный '+' и не меньше двух
+    // таких символов с цифрой в конце. Скобкам может предшествовать только префикс
+    // из цифры и хотя бы одного символа, после них — снова не меньше двух символов.
+    enum CharClass : uint8_t { Other, Digit, Separator, Plus, Open, Close, ClassCount };
+    enum State : uint8_t {
+        Reject, Start, AfterPlus,
+        PrefixFirstDigit, PrefixDigit, PrefixSeparator,
+        TailFirst, TailDigit, TailSeparator,
+        GroupStart, Group, AfterGroup, AfterGroupFirst, AfterGroupDigit, AfterGroupSeparator,
+        StateCount
     };
 
+    static constexpr void setRun(Dfa<StateCount, ClassCount>& dfa, uint8_t from, uint8_t digit, uint8_t separator) {
+        dfa.next[from][Digit] = digit;
+        dfa.next[from][Separator] = separator;
+    }
+
+    static constexpr Dfa<StateCount, ClassCount> makeDfa() {
+        Dfa<StateCount, ClassCount> dfa{};
+        for (int c = 0; c < 256; ++c) {
+            dfa.classOf[c] = c >= '0' && c <= '9' ? Digit
+                : c == '-' || c == '.' || c == ' ' ? Separator
+                : c == '+' ? Plus : c == '(' ? Open : c == ')' ? Close : Other;
+        }
+        dfa.next[Start][Plus] = AfterPlus;
+        for (uint8_t from : { Start, AfterPlus }) {
+            setRun(dfa, from, PrefixFirstDigit, TailFirst);
+            dfa.next[from][Open] = GroupStart;
+        }
+        setRun(dfa, PrefixFirstDigit, PrefixDigit, PrefixSeparator);
+        setRun(dfa, PrefixDigit, PrefixDigit, PrefixSeparator);
+        setRun(dfa, PrefixSeparator, PrefixDigit, PrefixSeparator);
+        dfa.next[PrefixDigit][Open] = GroupStart;
+        dfa.next[PrefixSeparator][Open] = GroupStart;
+        setRun(dfa, TailFirst, TailDigit, TailSeparator);
+        setRun(dfa, TailDigit, TailDigit, TailSeparator);
+        setRun(dfa, TailSeparator, TailDigit, TailSeparator);
+        setRun(dfa, GroupStart, Group, Group);
+        setRun(dfa, Group, Group, Group);
+        dfa.next[Group][Close] = AfterGroup;
+        setRun(dfa, AfterGroup, AfterGroupFirst, AfterGroupFirst);
+        setRun(dfa, AfterGroupFirst, AfterGroupDigit, AfterGroupSeparator);
+        setRun(dfa, AfterGroupDigit, AfterGroupDigit, AfterGroupSeparator);
+        setRun(dfa, AfterGroupSeparator, AfterGroupDigit, AfterGroupSeparator);
+        dfa.accepting[PrefixDigit] = true;
+        dfa.accepting[TailDigit] = true;
+        dfa.accepting[AfterGroupDigit] = true;
+        return dfa;
+    }
+
 public:
+    static bool matches(std::string_view phone) {
+        static constexpr Dfa<StateCount, ClassCount> dfa = makeDfa();
+        return dfa.matches(phone);
+    }
+
     void validate(const std::string& phone) const override {
         if (phone.empty()) {
             throw std::invalid_argument("Phone number cannot be empty");
         }
 
-        if (!std::regex_match(phone, phoneRegex)) {
+        if (!matches(phone)) {
             throw std::invalid_argument("Invalid phone number format: " + phone);
         }
     }
 
+    const char* check(std::string_view phone) const noexcept override {
+        if (phone.empty()) {
+            return "Phone number cannot be empty";
+        }
+        return matches(phone) ? nullptr : "Invalid phone number format";
+    }
+
     std::string getValidatorType() const override {
         return "Phone Validator";
     }
@@ -58,27 +185,121 @@ public:
 
 class AgeValidator : public DataValidator {
 public:
+    // Разбор как у std::stoi (пробелы в начале, знак, цифры, хвост после числа
+    // игнорируется), но без исключений; переполнение считается недопустимым возрастом.
+    static bool isValidAge(std::string_view ageStr) {
+        size_t pos = 0;
+        while (pos < ageStr.size() && (ageStr[pos] == ' ' || (ageStr[pos] >= '\t' && ageStr[pos] <= '\r'))) {
+            ++pos;
+        }
+        bool negative = false;
+        if (pos < ageStr.size() && (ageStr[pos] == '+' || ageStr[pos] == '-')) {
+            negative = ageStr[pos++] == '-';
+        }
+        const size_t digitsStart = pos;
+        int age = 0;
+        while (pos < ageStr.size() && ageStr[pos] >= '0' && ageStr[pos] <= '9') {
+            if (age <= 120) {
+                age = age * 10 + (ageStr[pos] - '0');
+            }
+            ++pos;
+        }
+        if (pos == digitsStart) {
+            return false;
+        }
+        return age <= 120 && (!negative || age == 0);
+    }
+
     void validate(const std::string& ageStr) const override {
         if (ageStr.empty()) {
             throw std::invalid_argument("Age cannot be empty");
         }
 
-        try {
-            int age = std::stoi(ageStr);
-            if (age < 0 || age > 120) {
-                throw std::invalid_argument("Age must be between 0 and 120");
-            }
-        }
-        catch (const std::invalid_argument&) {
+        if (!isValidAge(ageStr)) {
             throw std::invalid_argument("Invalid age value: " + ageStr);
         }
     }
 
+    const char* check(std::string_view ageStr) const noexcept override {
+        if (ageStr.empty()) {
+            return "Age cannot be empty";
+        }
+        return isValidAge(ageStr) ? nullptr : "Invalid age value";
+    }
+
     std::string getValidatorType() const override {
         return "Age Validator";
     }
 };
 
+struct ValidationFailure {
+    size_t row;
+    const char* reason;
+};
+
+// Результат проверки столбца: битовая карта отказов (бит i — строка i не прошла)
+// и список отказов по возрастанию номера строки.
+struct ColumnValidation {
+    std::vector<uint64_t> failedRows;
+    std::vector<ValidationFailure> failures;
+
+    bool failed(size_t row) const {
+        return (failedRows[row / 64] >> (row % 64)) & 1;
+    }
+
+    size_t failureCount() const {
+        return failures.size();
+    }
+};
+
+// Проверяет весь столбец без исключений на горячем пути. Столбец делится на фрагменты,
+// кратные 64 строкам, поэтому каждый поток пишет в свои слова битовой карты;
+// отказы потоков склеиваются в исходном порядке.
+template <typename Value>
+ColumnValidation validateColumn(const DataValidator& validator, const std::vector<Value>& values,
+    unsigned threads = std::thread::hardware_concurrency()) {
+    constexpr size_t kMinRowsPerThread = 64 * 1024;
+
+    ColumnValidation result;
+    result.failedRows.assign((values.size() + 63) / 64, 0);
+
+    const size_t maxThreads = std::max<size_t>(1, threads);
+    const size_t chunkCount = std::max<size_t>(1, std::min(maxThreads, values.size() / kMinRowsPerThread));
+    const size_t chunkRows = ((values.size() + chunkCount - 1) / chunkCount + 63) / 64 * 64;
+    std::vector<std::vector<ValidationFailure>> chunkFailures(chunkCount);
+
+    auto validateChunk = [&](size_t chunk) {
+        const size_t begin = std::min(values.size(), chunk * chunkRows);
+        const size_t end = std::min(values.size(), begin + chunkRows);
+        auto& failures = chunkFailures[chunk];
+        for (size_t row = begin; row < end; ++row) {
+            if (const char* reason = validator.check(values[row])) {
+                result.failedRows[row / 64] |= uint64_t(1) << (row % 64);
+                failures.push_back({ row, reason });
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (size_t chunk = 1; chunk < chunkCount; ++chunk) {
+        workers.emplace_back(validateChunk, chunk);
+    }
+    validateChunk(0);
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    size_t total = 0;
+    for (const auto& failures : chunkFailures) {
+        total += failures.size();
+    }
+    result.failures.reserve(total);
+    for (const auto& failures : chunkFailures) {
+        result.failures.insert(result.failures.end(), failures.begin(), failures.end());
+    }
+    return result;
+}
+
 void testValidator(DataValidator& validator, const std::string& testData) {
     try {
         std::cout << "Testing " << validator.getValidatorType()
@@ -91,7 +312,162 @@ void testValidator(DataValidator& validator, const std::string& testData) {
     }
 }
 
-int main() {
+// Сверка автоматов с исходными регулярными выражениями: все строки до заданной длины
+// над алфавитом из значимых символов и случайные строки подлиннее. Дефис в [\d-. ]
+// экранирован: libstdc++ отвергает неэкранированный вариант, MSVC читает его как литерал.
+template <typename Matches>
+size_t verifyAgainstRegex(const std::string& name, const std::regex& reference, std::string_view alphabet,
+    size_t maxLength, Matches&& matches) {
+    size_t checked = 0;
+    size_t mismatches = 0;
+    auto check = [&](const std::string& text) {
+        ++checked;
+        if (std::regex_match(text, reference) != matches(text)) {
+            if (++mismatches <= 10) {
+                std::cerr << name << " mismatch: \"" << text << "\"" << std::endl;
+            }
+        }
+    };
+
+    std::string text;
+    std::vector<size_t> digits;
+    for (size_t length = 1; length <= maxLength; ++length) {
+        digits.assign(length, 0);
+        text.assign(length, alphabet[0]);
+        while (true) {
+            check(text);
+            size_t i = 0;
+            while (i < length && ++digits[i] == alphabet.size()) {
+                digits[i] = 0;
+                text[i] = alphabet[0];
+                ++i;
+            }
+            if (i == length) {
+                break;
+            }
+            text[i] = alphabet[digits[i]];
+        }
+    }
+
+    std::mt19937 random(70);
+    for (int n = 0; n < 200000; ++n) {
+        text.resize(maxLength + 1 + random() % 24);
+        for (char& c : text) {
+            c = alphabet[random() % alphabet.size()];
+        }
+        check(text);
+    }
+
+    std::cout << name << ": " << checked << " strings, " << mismatches << " mismatches" << std::endl;
+    return mismatches;
+}
+
+template <typename Matches>
+void compareSpeed(const std::string& name, const std::regex& reference, const std::vector<std::string>& samples,
+    Matches&& matches) {
+    auto measure = [&](auto&& match) {
+        size_t accepted = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int round = 0; round < 100; ++round) {
+            for (const auto& sample : samples) {
+                accepted += match(sample);
+            }
+        }
+        std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+        return std::make_pair(elapsed.count() / (100.0 * samples.size()), accepted);
+    };
+    auto regexTime = measure([&](const std::string& text) { return std::regex_match(text, reference); });
+    auto dfaTime = measure([&](const std::string& text) { return matches(text); });
+    std::cout << name << ": regex " << regexTime.first << " ns, DFA " << dfaTime.first << " ns per value"
+        << (regexTime.second == dfaTime.second ? "" : " (results differ!)") << std::endl;
+}
+
+int verifyValidators() {
+    const std::regex emailRegex{ R"((\w+)(\.|_)?(\w*)@(\w+)(\.(\w+))+)" };
+    const std::regex phoneRegex{ R"(^\+?(\d[\d\-. ]+)?(\([\d\-. ]+\))?[\d\-. ]+\d$)" };
+
+    size_t mismatches = 0;
+    mismatches += verifyAgainstRegex("Email", emailRegex, "a_.@-1", 7, EmailValidator::matches);
+    mismatches += verifyAgainstRegex("Phone", phoneRegex, "+1-. ()a", 7, PhoneValidator::matches);
+
+    const std::string ageAlphabet = "0129 +-\ta";
+    std::mt19937 random(16);
+    size_t ageMismatches = 0;
+    for (int n = 0; n < 200000; ++n) {
+        std::string text(1 + random() % 6, ' ');
+        for (char& c : text) {
+            c = ageAlphabet[random() % ageAlphabet.size()];
+        }
+        bool expected;
+        try {
+            int age = std::stoi(text);
+            expected = age >= 0 && age <= 120;
+        }
+        catch (const std::exception&) {
+            expected = false;
+        }
+        if (expected != AgeValidator::isValidAge(text) && ++ageMismatches <= 10) {
+            std::cerr << "Age mismatch: \"" << text << "\"" << std::endl;
+        }
+    }
+    std::cout << "Age: 200000 strings, " << ageMismatches << " mismatches" << std::endl;
+    mismatches += ageMismatches;
+
+    compareSpeed("Email", emailRegex,
+        { "test@example.com", "john.smith@mail.example.org", "invalid-email", "user_name@host" },
+        EmailValidator::matches);
+    compareSpeed("Phone", phoneRegex,
+        { "+1234567890", "+7 (495) 123-45-67", "8.800.555.35.35", "not-a-phone" },
+        PhoneValidator::matches);
+
+    return mismatches == 0 ? 0 : 1;
+}
+
+// Столбец телефонов с долей некорректных значений: поштучная проверка через
+// исключения против validateColumn() в одном и нескольких потоках.
+void benchmarkColumnValidation(size_t rows) {
+    std::vector<std::string> phones(rows);
+    for (size_t i = 0; i < rows; ++i) {
+        phones[i] = i % 4 == 0 ? "not-a-phone" : "+7 (495) " + std::to_string(1000000 + i % 9000000);
+    }
+    PhoneValidator validator;
+
+    auto measure = [&](const std::string& name, auto&& run) {
+        auto start = std::chrono::steady_clock::now();
+        size_t failures = run();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << name << ": " << rows / elapsed.count() / 1e6 << " M rows/s, " << failures << " failures" << std::endl;
+    };
+
+    measure("validate() with exceptions", [&]() {
+        size_t failures = 0;
+        for (const auto& phone : phones) {
+            try {
+                validator.validate(phone);
+            }
+            catch (const std::invalid_argument&) {
+                ++failures;
+            }
+        }
+        return failures;
+    });
+    measure("validateColumn() 1 thread", [&]() {
+        return validateColumn(validator, phones, 1).failureCount();
+    });
+    measure("validateColumn() all threads", [&]() {
+        return validateColumn(validator, phones).failureCount();
+    });
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1 && std::string(argv[1]) == "--verify") {
+        return verifyValidators();
+    }
+    if (argc > 1 && std::string(argv[1]) == "--bench") {
+        benchmarkColumnValidation(argc > 2 ? std::stoull(argv[2]) : 5000000);
+        return 0;
+    }
+
     EmailValidator emailValidator;
     PhoneValidator phoneValidator;
     AgeValidator ageValidator;
@@ -106,5 +482,13 @@ int main() {
     testValidator(ageValidator, "150");
     testValidator(ageValidator, "not-a-number");
 
+    std::vector<std::string> phones = { "+1234567890", "not-a-phone", "+7 (495) 123-45-67", "", "12" };
+    ColumnValidation phoneColumn = validateColumn(phoneValidator, phones);
+    std::cout << "\nBulk " << phoneValidator.getValidatorType() << ": " << phoneColumn.failureCount()
+        << " of " << phones.size() << " values failed" << std::endl;
+    for (const auto& failure : phoneColumn.failures) {
+        std::cout << "Row " << failure.row << ": " << failure.reason << std::endl;
+    }
+
     return 0;
 }
\ No newline at end of file
@@ -1,22 +1,564 @@
 ﻿#include <iostream>
+#include <fstream>
 #include <stdexcept>
 #include <string>
 #include <vector>
 #include <sstream>
 #include <map>
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <condition_variable>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <cstdlib>
+#include <iomanip>
+#include <new>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define CSV_SCAN_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CSV_SCAN_SSE2
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#if defined(WITH_BENCHMARKS)
+#include "../bench/bench_harness.h"
+#endif
+
+// Ядро токенизатора CSV: ищет разделители и переводы строк блоками по 64 байта.
+// Кавычки CSVDataProcessor не разбирает, поэтому маска для них не строится.
+// Для каждого блока строятся битовые маски (AVX2 — 2x32 байта, SSE2 — 4x16 байт),
+// на платформах без SIMD используется скалярный проход.
+class StructuralScanner {
+public:
+    static constexpr size_t kBlockSize = 64;
+
+    struct BlockMasks {
+        uint64_t delimiters;
+        uint64_t newlines;
+    };
+
+    explicit StructuralScanner(char delim = ',')
+        : delimiter(delim) {}
+
+    char getDelimiter() const {
+        return delimiter;
+    }
+
+    // Маски для полного блока: требуется kBlockSize доступных байт.
+    BlockMasks scanBlock(const char* data) const {
+#if defined(CSV_SCAN_AVX2)
+        const __m256i delimiterVec = _mm256_set1_epi8(delimiter);
+        const __m256i newlineVec = _mm256_set1_epi8('\n');
+        const __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+        const __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + 32));
+
+        auto mask = [&](__m256i needle) {
+            uint64_t low = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, needle)));
+            uint64_t high = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, needle)));
+            return low | (high << 32);
+        };
+
+        return { mask(delimiterVec), mask(newlineVec) };
+#elif defined(CSV_SCAN_SSE2)
+        const __m128i delimiterVec = _mm_set1_epi8(delimiter);
+        const __m128i newlineVec = _mm_set1_epi8('\n');
+        BlockMasks masks{ 0, 0 };
+
+        for (int lane = 0; lane < 4; ++lane) {
+            const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + lane * 16));
+            const int shift = lane * 16;
+            masks.delimiters |= static_cast<uint64_t>(
+                static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, delimiterVec)))) << shift;
+            masks.newlines |= static_cast<uint64_t>(
+                static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, newlineVec)))) << shift;
+        }
+
+        return masks;
+#else
+        return scanTail(data, kBlockSize);
+#endif
+    }
+
+    // Скалярный вариант для хвоста короче блока.
+    BlockMasks scanTail(const char* data, size_t length) const {
+        BlockMasks masks{ 0, 0 };
+        for (size_t i = 0; i < length; ++i) {
+            const uint64_t bit = uint64_t(1) << i;
+            if (data[i] == delimiter) masks.delimiters |= bit;
+            else if (data[i] == '\n') masks.newlines |= bit;
+        }
+        return masks;
+    }
+
+    static unsigned lowestBit(uint64_t mask) {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+        unsigned long index;
+        _BitScanForward64(&index, mask);
+        return static_cast<unsigned>(index);
+#elif defined(_MSC_VER)
+        unsigned long index;
+        if (_BitScanForward(&index, static_cast<unsigned long>(mask))) {
+            return static_cast<unsigned>(index);
+        }
+        _BitScanForward(&index, static_cast<unsigned long>(mask >> 32));
+        return static_cast<unsigned>(index) + 32;
+#else
+        return static_cast<unsigned>(__builtin_ctzll(mask));
+#endif
+    }
+
+    // Разбивает текст на поля без учёта кавычек. onField(std::string_view) вызывается
+    // для каждого поля, onRecordEnd() — в конце каждой записи; если он вернёт false,
+    // разбор прекращается. '\r' перед переводом строки отбрасывается.
+    // Как и прежний цикл std::getline, пустое последнее поле записи не выдаётся:
+    // "a,b," даёт "a" и "b", пустая строка — запись без полей.
+    template <typename OnField, typename OnRecordEnd>
+    void tokenize(std::string_view input, OnField&& onField, OnRecordEnd&& onRecordEnd) const {
+        const char* data = input.data();
+        const size_t size = input.size();
+        size_t fieldStart = 0;
+
+        for (size_t block = 0; block < size; block += kBlockSize) {
+            const size_t length = std::min(kBlockSize, size - block);
+            const BlockMasks masks = length == kBlockSize ? scanBlock(data + block) : scanTail(data + block, length);
+            uint64_t structural = masks.delimiters | masks.newlines;
+
+            while (structural) {
+                const size_t pos = block + lowestBit(structural);
+                structural &= structural - 1;
+
+                if (data[pos] == '\n') {
+                    size_t fieldEnd = pos;
+                    if (fieldEnd > fieldStart && data[fieldEnd - 1] == '\r') {
+                        --fieldEnd;
+                    }
+                    if (fieldEnd > fieldStart) {
+                        onField(std::string_view(data + fieldStart, fieldEnd - fieldStart));
+                    }
+                    fieldStart = pos + 1;
+                    if (!onRecordEnd()) {
+                        return;
+                    }
+                }
+                else {
+                    onField(std::string_view(data + fieldStart, pos - fieldStart));
+                    fieldStart = pos + 1;
+                }
+            }
+        }
+
+        if (size > 0 && data[size - 1] != '\n') {
+            size_t fieldEnd = size;
+            if (fieldEnd > fieldStart && data[fieldEnd - 1] == '\r') {
+                --fieldEnd;
+            }
+            if (fieldEnd > fieldStart) {
+                onField(std::string_view(data + fieldStart, fieldEnd - fieldStart));
+            }
+            onRecordEnd();
+        }
+    }
+
+private:
+    char delimiter;
+};
+
+
+// Арена блоков: копирует строки в заранее выделенные блоки, reset() за O(1)
+// возвращает её в начало без освобождения памяти.
+class Arena {
+public:
+    static constexpr size_t kBlockSize = 64 * 1024;
+
+    std::string_view copy(std::string_view value) {
+        if (value.empty()) {
+            return std::string_view("", 0);
+        }
+        if (blocks.empty() || used + value.size() > blocks[current].size) {
+            nextBlock(value.size());
+        }
+        char* target = blocks[current].data.get() + used;
+        std::memcpy(target, value.data(), value.size());
+        used += value.size();
+        return std::string_view(target, value.size());
+    }
+
+    void reset() {
+        current = 0;
+        used = 0;
+    }
+
+private:
+    struct Block {
+        std::unique_ptr<char[]> data;
+        size_t size;
+    };
+
+    std::vector<Block> blocks;
+    size_t current = 0;
+    size_t used = 0;
+
+    void nextBlock(size_t required) {
+        if (!blocks.empty()) {
+            ++current;
+        }
+        while (current < blocks.size() && blocks[current].size < required) {
+            ++current;
+        }
+        if (current >= blocks.size()) {
+            const size_t size = std::max(kBlockSize, required);
+            blocks.push_back(Block{ std::unique_ptr<char[]>(new char[size]), size });
+            current = blocks.size() - 1;
+        }
+        used = 0;
+    }
+};
+
+// Переиспользуемый контекст разбора: ключи интернируются и живут между записями,
+// значения копируются в арену. Плоская хеш-таблица с открытой адресацией;
+// reset() за O(1) увеличивает номер поколения, делая все значения недействительными.
+// Ключи не вытесняются по одному: если их накопилось больше kMaxKeys (индексы массивов,
+// идентификаторы в именах полей), reset() очищает таблицу и арену ключей целиком.
+class ParseContext {
+public:
+    static constexpr size_t kMaxKeys = 64 * 1024;
+
+    ParseContext() : slots(kInitialCapacity) {}
+
+    void reset() {
+        ++generation;
+        values.reset();
+        order.clear();
+        if (keyCount > kMaxKeys) {
+            std::vector<Slot>(kInitialCapacity).swap(slots);
+            keys = Arena();
+            keyCount = 0;
+        }
+    }
+
+    void set(std::string_view key, std::string_view value) {
+        if ((keyCount + 1) * 2 > slots.size()) {
+            grow();
+        }
+
+        const uint64_t hash = hashKey(key);
+        Slot& slot = slots[findIndex(key, hash)];
+        if (slot.key.data() == nullptr) {
+            slot.key = keys.copy(key);
+            slot.hash = hash;
+            ++keyCount;
+        }
+        if (slot.generation != generation) {
+            slot.generation = generation;
+            order.push_back(static_cast<uint32_t>(&slot - slots.data()));
+        }
+        slot.value = values.copy(value);
+    }
+
+    // Значение ключа в текущей записи; nullptr, если ключа нет
+    const std::string_view* find(std::string_view key) const {
+        const Slot& slot = slots[findIndex(key, hashKey(key))];
+        return slot.key.data() != nullptr && slot.generation == generation ? &slot.value : nullptr;
+    }
+
+    size_t size() const {
+        return order.size();
+    }
+
+    // Обход пар текущей записи в порядке вставки
+    template <typename Visitor>
+    void forEach(Visitor&& visitor) const {
+        for (uint32_t index : order) {
+            visitor(slots[index].key, slots[index].value);
+        }
+    }
+
+    std::map<std::string, std::string> toMap() const {
+        std::map<std::string, std::string> result;
+        forEach([&](std::string_view key, std::string_view value) {
+            result[std::string(key)] = std::string(value);
+        });
+        return result;
+    }
+
+private:
+    static constexpr size_t kInitialCapacity = 64;
+
+    struct Slot {
+        std::string_view key;
+        std::string_view value;
+        uint64_t hash = 0;
+        uint64_t generation = 0;
+    };
+
+    std::vector<Slot> slots;
+    std::vector<uint32_t> order;
+    Arena keys;
+    Arena values;
+    size_t keyCount = 0;
+    uint64_t generation = 1;
+
+    static uint64_t hashKey(std::string_view key) {
+        uint64_t hash = 14695981039346656037ull;
+        for (char c : key) {
+            hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ull;
+        }
+        return hash;
+    }
+
+    size_t findIndex(std::string_view key, uint64_t hash) const {
+        const size_t mask = slots.size() - 1;
+        for (size_t index = hash & mask;; index = (index + 1) & mask) {
+            const Slot& slot = slots[index];
+            if (slot.key.data() == nullptr || (slot.hash == hash && slot.key == key)) {
+                return index;
+            }
+        }
+    }
+
+    void grow() {
+        std::vector<Slot> old(slots.size() * 2);
+        old.swap(slots);
+        const size_t mask = slots.size() - 1;
+        std::vector<uint32_t> remap(old.size(), 0);
+        for (size_t i = 0; i < old.size(); ++i) {
+            if (old[i].key.data() == nullptr) {
+                continue;
+            }
+            size_t index = old[i].hash & mask;
+            while (slots[index].key.data() != nullptr) {
+                index = (index + 1) & mask;
+            }
+            slots[index] = old[i];
+            remap[i] = static_cast<uint32_t>(index);
+        }
+        for (uint32_t& index : order) {
+            index = remap[index];
+        }
+    }
+};
+
+enum class ProcessStatus {
+    Ok,
+    InvalidArgument,
+    ParseError
+};
+
+// Результат обработки одной записи пакета
+struct BatchResult {
+    ProcessStatus status = ProcessStatus::Ok;
+    std::string message;
+    std::map<std::string, std::string> values;
+};
 
 class DataProcessor {
 protected:
-    virtual void validateData(const std::string& data) const {
+    static ProcessStatus reject(std::string& message, ProcessStatus status, const std::string& text) {
+        message = text;
+        return status;
+    }
+
+    virtual ProcessStatus validateData(std::string_view data, std::string& message) const {
         if (data.empty()) {
-            throw std::invalid_argument("Data cannot be empty");
+            return reject(message, ProcessStatus::InvalidArgument, "Data cannot be empty");
         }
+        return ProcessStatus::Ok;
     }
 
+private:
+    // Постоянный пул processBatch(): потоки создаются при первом вызове и живут вместе
+    // с процессором, у каждого (и у вызывающего потока) свой клон и ParseContext.
+    // Пакет раздаётся по номеру поколения через condition_variable.
+    class BatchPool {
+    public:
+        using Job = std::function<void(DataProcessor&, ParseContext&)>;
+
+        explicit BatchPool(const DataProcessor& owner) : prototype(owner), caller{ owner.clone(), {} } {}
+
+        BatchPool(const BatchPool&) = delete;
+        BatchPool& operator=(const BatchPool&) = delete;
+
+        ~BatchPool() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopping = true;
+            }
+            wake.notify_all();
+            for (auto& thread : threads) {
+                thread.join();
+            }
+        }
+
+        // Выполняет job в workerCount потоках, считая вызывающий; пакеты идут по одному
+        void run(size_t workerCount, const Job& job) {
+            std::lock_guard<std::mutex> batchLock(batchMutex);
+            while (workers.size() + 1 < workerCount) {
+                workers.push_back(std::make_unique<Worker>(Worker{ prototype.clone(), {} }));
+                Worker* worker = workers.back().get();
+                const size_t index = workers.size() - 1;
+                std::lock_guard<std::mutex> lock(mutex);
+                threads.emplace_back([this, worker, index, seen = generation]() {
+                    workerLoop(*worker, index, seen);
+                });
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                currentJob = &job;
+                activeWorkers = workerCount - 1;
+                running = activeWorkers;
+                failure = nullptr;
+                ++generation;
+            }
+            wake.notify_all();
+
+            std::exception_ptr callerFailure;
+            try {
+                job(*caller.processor, caller.context);
+            }
+            catch (...) {
+                callerFailure = std::current_exception();
+            }
+
+            std::unique_lock<std::mutex> lock(mutex);
+            done.wait(lock, [this]() { return running == 0; });
+            currentJob = nullptr;
+            if (callerFailure) {
+                std::rethrow_exception(callerFailure);
+            }
+            if (failure) {
+                std::rethrow_exception(failure);
+            }
+        }
+
+    private:
+        struct Worker {
+            std::unique_ptr<DataProcessor> processor;
+            ParseContext context;
+        };
+
+        const DataProcessor& prototype;
+        Worker caller;
+        std::vector<std::unique_ptr<Worker>> workers;
+        std::vector<std::thread> threads;
+        std::mutex batchMutex;
+
+        std::mutex mutex;
+        std::condition_variable wake;
+        std::condition_variable done;
+        const Job* currentJob = nullptr;
+        size_t activeWorkers = 0;
+        size_t running = 0;
+        uint64_t generation = 0;
+        bool stopping = false;
+        std::exception_ptr failure;
+
+        void workerLoop(Worker& worker, size_t index, uint64_t seen) {
+            for (;;) {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [&]() { return stopping || generation != seen; });
+                if (stopping) {
+                    return;
+                }
+                seen = generation;
+                if (index >= activeWorkers) {
+                    continue;
+                }
+                const Job& job = *currentJob;
+                lock.unlock();
+
+                try {
+                    job(*worker.processor, worker.context);
+                }
+                catch (...) {
+                    std::lock_guard<std::mutex> failureLock(mutex);
+                    if (!failure) {
+                        failure = std::current_exception();
+                    }
+                }
+
+                lock.lock();
+                if (--running == 0) {
+                    done.notify_one();
+                }
+            }
+        }
+    };
+
+    mutable std::once_flag batchPoolOnce;
+    mutable std::unique_ptr<BatchPool> batchPool;
+
 public:
+    static constexpr size_t kBatchChunkSize = 256;
+
     virtual ~DataProcessor() = default;
 
-    virtual std::map<std::string, std::string> processData(const std::string& data) = 0;
+    // Разбор без исключений: при ошибке возвращает статус и заполняет message
+    virtual ProcessStatus tryProcessData(std::string_view data, ParseContext& context, std::string& message) = 0;
+
+    // Копия процессора с теми же настройками для отдельного потока
+    virtual std::unique_ptr<DataProcessor> clone() const = 0;
+
+    // Разбор в переиспользуемый контекст; после прогрева память не выделяется
+    void processData(std::string_view data, ParseContext& context) {
+        std::string message;
+        switch (tryProcessData(data, context, message)) {
+        case ProcessStatus::Ok:
+            return;
+        case ProcessStatus::InvalidArgument:
+            throw std::invalid_argument(message);
+        default:
+            throw std::runtime_error(message);
+        }
+    }
+
+    // Обёртка над разбором в контекст: результат копируется в map
+    std::map<std::string, std::string> processData(const std::string& data) {
+        ParseContext context;
+        processData(data, context);
+        return context.toMap();
+    }
+
+    // Пакетная обработка: записи раздаются потокам блоками по kBatchChunkSize,
+    // у каждого потока постоянного пула свой клон процессора и контекст. Результаты — в порядке
+    // входных записей, ошибка записи возвращается статусом, а не исключением.
+    std::vector<BatchResult> processBatch(const std::vector<std::string_view>& records,
+        unsigned threadCount = std::thread::hardware_concurrency()) const {
+        std::vector<BatchResult> results(records.size());
+        const size_t chunks = (records.size() + kBatchChunkSize - 1) / kBatchChunkSize;
+        const size_t workerCount = std::max<size_t>(1, std::min<size_t>(threadCount, chunks));
+        std::atomic<size_t> nextChunk{ 0 };
+
+        std::call_once(batchPoolOnce, [this]() { batchPool = std::make_unique<BatchPool>(*this); });
+        batchPool->run(workerCount, [&](DataProcessor& processor, ParseContext& context) {
+            for (size_t chunk = nextChunk++; chunk < chunks; chunk = nextChunk++) {
+                const size_t end = std::min(records.size(), (chunk + 1) * kBatchChunkSize);
+                for (size_t i = chunk * kBatchChunkSize; i < end; ++i) {
+                    BatchResult& result = results[i];
+                    result.status = processor.tryProcessData(records[i], context, result.message);
+                    if (result.status == ProcessStatus::Ok) {
+                        result.values = context.toMap();
+                    }
+                }
+            }
+        });
+
+        return results;
+    }
 
     virtual std::string getProcessorType() const = 0;
 };
@@ -24,57 +566,62 @@ public:
 class CSVDataProcessor : public DataProcessor {
 private:
     char delimiter;
+    StructuralScanner scanner;
+    std::vector<std::string_view> headers;
+    std::vector<std::string_view> values;
 
-    void validateData(const std::string& data) const override {
-        DataProcessor::validateData(data);
-        if (data.find(delimiter) == std::string::npos) {
-            throw std::invalid_argument("CSV data must contain delimiter");
+    ProcessStatus validateData(std::string_view data, std::string& message) const override {
+        if (DataProcessor::validateData(data, message) != ProcessStatus::Ok) {
+            return ProcessStatus::InvalidArgument;
+        }
+        if (data.find(delimiter) == std::string_view::npos) {
+            return reject(message, ProcessStatus::InvalidArgument, "CSV data must contain delimiter");
         }
+        return ProcessStatus::Ok;
     }
 
 public:
-    explicit CSVDataProcessor(char delim = ',') : delimiter(delim) {}
-
-    std::map<std::string, std::string> processData(const std::string& data) override {
-        validateData(data);
+    explicit CSVDataProcessor(char delim = ',') : delimiter(delim), scanner(delim) {}
 
-        std::map<std::string, std::string> result;
-        std::istringstream ss(data);
-        std::string line;
+    std::unique_ptr<DataProcessor> clone() const override {
+        return std::make_unique<CSVDataProcessor>(delimiter);
+    }
 
-        // Чтение заголовков
-        if (!std::getline(ss, line)) {
-            throw std::runtime_error("Failed to read CSV headers");
+    ProcessStatus tryProcessData(std::string_view data, ParseContext& context, std::string& message) override {
+        if (validateData(data, message) != ProcessStatus::Ok) {
+            return ProcessStatus::InvalidArgument;
         }
 
-        std::vector<std::string> headers;
-        std::istringstream headerStream(line);
-        std::string header;
-        while (std::getline(headerStream, header, delimiter)) {
-            headers.push_back(header);
-        }
+        context.reset();
+        headers.clear();
+        values.clear();
+        size_t records = 0;
+
+        // Заголовки — первая запись, данные — вторая; дальше разбор не идёт
+        scanner.tokenize(data,
+            [&](std::string_view field) {
+                (records == 0 ? headers : values).push_back(field);
+            },
+            [&]() {
+                return ++records < 2;
+            });
 
-        // Чтение данных
-        if (!std::getline(ss, line)) {
-            throw std::runtime_error("Failed to read CSV data");
+        if (records < 1) {
+            return reject(message, ProcessStatus::ParseError, "Failed to read CSV headers");
         }
 
-        std::vector<std::string> values;
-        std::istringstream valueStream(line);
-        std::string value;
-        while (std::getline(valueStream, value, delimiter)) {
-            values.push_back(value);
+        if (records < 2) {
+            return reject(message, ProcessStatus::ParseError, "Failed to read CSV data");
         }
 
         if (headers.size() != values.size()) {
-            throw std::runtime_error("CSV headers and values count mismatch");
+            return reject(message, ProcessStatus::ParseError, "CSV headers and values count mismatch");
         }
 
         for (size_t i = 0; i < headers.size(); ++i) {
-            result[headers[i]] = values[i];
+            context.set(headers[i], values[i]);
         }
-
-        return result;
+        return ProcessStatus::Ok;
     }
 
     std::string getProcessorType() const override {
@@ -82,50 +629,392 @@ public:
     }
 };
 
-class XMLDataProcessor : public DataProcessor {
-protected:
-    void validateData(const std::string& data) const override {
-        DataProcessor::validateData(data);
-        if (data.find('<') == std::string::npos ||
-            data.find('>') == std::string::npos) {
-            throw std::invalid_argument("Invalid XML format");
+enum class XmlEvent {
+    StartElement,
+    EndElement,
+    Attribute,
+    Text,
+    EndDocument,
+    Error
+};
+
+// Потоковый (pull) парсер XML: каждый вызов next() возвращает одно событие.
+// Документ читается один раз слева направо, стек элементов ограничен kMaxDepth,
+// elementPath() возвращает путь текущего элемента вида "user/name".
+// При ошибке возвращается XmlEvent::Error, описание доступно через error().
+class XmlPullParser {
+public:
+    static constexpr size_t kMaxDepth = 256;
+
+    void reset(std::string_view input) {
+        text = input;
+        pos = 0;
+        path.clear();
+        pathLengths.clear();
+        inStartTag = false;
+        popPending = false;
+        errorMessage.clear();
+    }
+
+    XmlEvent next() {
+        if (!errorMessage.empty()) {
+            return XmlEvent::Error;
+        }
+
+        if (popPending) {
+            popPending = false;
+            path.resize(pathLengths.back());
+            pathLengths.pop_back();
+        }
+
+        if (inStartTag) {
+            skipWhitespace();
+            if (startsWith("/>")) {
+                pos += 2;
+                inStartTag = false;
+                popPending = true;
+                currentName = elementName();
+                return XmlEvent::EndElement;
+            }
+            if (startsWith(">")) {
+                ++pos;
+                inStartTag = false;
+            }
+            else {
+                return readAttribute();
+            }
         }
+
+        while (pos < text.size()) {
+            if (text[pos] != '<') {
+                size_t end = text.find('<', pos);
+                if (end == std::string_view::npos) {
+                    end = text.size();
+                }
+                std::string_view raw = text.substr(pos, end - pos);
+                pos = end;
+                if (raw.find_first_not_of(" \t\r\n") == std::string_view::npos) {
+                    continue;
+                }
+                if (pathLengths.empty()) {
+                    return fail("Text outside root element");
+                }
+                currentName = elementName();
+                if (!decode(raw, currentValue)) {
+                    return XmlEvent::Error;
+                }
+                return XmlEvent::Text;
+            }
+
+            if (startsWith("<!--")) {
+                if (!skipPast("-->", "Unterminated comment")) {
+                    return XmlEvent::Error;
+                }
+            }
+            else if (startsWith("<![CDATA[")) {
+                const size_t start = pos + 9;
+                if (!skipPast("]]>", "Unterminated CDATA section")) {
+                    return XmlEvent::Error;
+                }
+                if (pathLengths.empty()) {
+                    return fail("Text outside root element");
+                }
+                currentName = elementName();
+                currentValue = text.substr(start, pos - 3 - start);
+                return XmlEvent::Text;
+            }
+            else if (startsWith("<?")) {
+                if (!skipPast("?>", "Unterminated processing instruction")) {
+                    return XmlEvent::Error;
+                }
+            }
+            else if (startsWith("<!")) {
+                if (!skipPast(">", "Unterminated declaration")) {
+                    return XmlEvent::Error;
+                }
+            }
+            else if (startsWith("</")) {
+                pos += 2;
+                std::string_view name;
+                if (!readName(name)) {
+                    return XmlEvent::Error;
+                }
+                skipWhitespace();
+                if (pos >= text.size() || text[pos] != '>') {
+                    return fail("Malformed XML tag");
+                }
+                ++pos;
+                if (pathLengths.empty() || name != elementName()) {
+                    errorMessage = "Missing closing tag for: " +
+                        (pathLengths.empty() ? std::string(name) : std::string(elementName()));
+                    return XmlEvent::Error;
+                }
+                currentName = name;
+                popPending = true;
+                return XmlEvent::EndElement;
+            }
+            else {
+                ++pos;
+                std::string_view name;
+                if (!readName(name)) {
+                    return XmlEvent::Error;
+                }
+                if (pathLengths.size() >= kMaxDepth) {
+                    return fail("XML nesting too deep");
+                }
+                pathLengths.push_back(path.size());
+                if (!path.empty()) {
+                    path.push_back('/');
+                }
+                path.append(name);
+                currentName = elementName();
+                inStartTag = true;
+                return XmlEvent::StartElement;
+            }
+        }
+
+        if (!pathLengths.empty()) {
+            errorMessage = "Missing closing tag for: " + std::string(elementName());
+            return XmlEvent::Error;
+        }
+        return XmlEvent::EndDocument;
     }
 
-public:
-    std::map<std::string, std::string> processData(const std::string& data) override {
-        validateData(data);
+    const std::string& error() const {
+        return errorMessage;
+    }
 
-        std::map<std::string, std::string> result;
-        size_t pos = 0;
+    // Имя элемента или атрибута текущего события
+    std::string_view name() const {
+        return currentName;
+    }
 
-        while (true) {
-            size_t startTag = data.find('<', pos);
-            if (startTag == std::string::npos) break;
+    // Текст или значение атрибута; действительно до следующего вызова next()
+    std::string_view value() const {
+        return currentValue;
+    }
+
+    std::string_view elementPath() const {
+        return path;
+    }
+
+    size_t depth() const {
+        return pathLengths.size();
+    }
+
+private:
+    std::string_view text;
+    size_t pos = 0;
+    std::string path;
+    std::vector<size_t> pathLengths;
+    std::string scratch;
+    std::string_view currentName;
+    std::string_view currentValue;
+    bool inStartTag = false;
+    bool popPending = false;
+    std::string errorMessage;
+
+    XmlEvent fail(const char* message) {
+        errorMessage = std::string(message) + " at offset " + std::to_string(pos);
+        return XmlEvent::Error;
+    }
+
+    bool startsWith(std::string_view prefix) const {
+        return text.compare(pos, prefix.size(), prefix) == 0;
+    }
+
+    void skipWhitespace() {
+        while (pos < text.size() && (text[pos] == ' ' || text[pos] == '\t' || text[pos] == '\n' || text[pos] == '\r')) {
+            ++pos;
+        }
+    }
 
-            size_t endTag = data.find('>', startTag);
-            if (endTag == std::string::npos) {
-                throw std::runtime_error("Malformed XML tag");
+    bool skipPast(std::string_view terminator, const char* message) {
+        size_t end = text.find(terminator, pos);
+        if (end == std::string_view::npos) {
+            fail(message);
+            return false;
+        }
+        pos = end + terminator.size();
+        return true;
+    }
+
+    std::string_view elementName() const {
+        const size_t start = pathLengths.back() + (pathLengths.back() == 0 ? 0 : 1);
+        return std::string_view(path).substr(start);
+    }
+
+    bool readName(std::string_view& name) {
+        const size_t start = pos;
+        while (pos < text.size()) {
+            char c = text[pos];
+            if (c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '/' || c == '>' || c == '=') {
+                break;
             }
+            ++pos;
+        }
+        if (pos == start) {
+            fail("Empty tag name");
+            return false;
+        }
+        name = text.substr(start, pos - start);
+        return true;
+    }
+
+    XmlEvent readAttribute() {
+        if (!readName(currentName)) {
+            return XmlEvent::Error;
+        }
+        skipWhitespace();
+        if (pos >= text.size() || text[pos] != '=') {
+            return fail("Missing '=' after attribute name");
+        }
+        ++pos;
+        skipWhitespace();
+        if (pos >= text.size() || (text[pos] != '"' && text[pos] != '\'')) {
+            return fail("Attribute value must be quoted");
+        }
+        const char quote = text[pos++];
+        size_t end = text.find(quote, pos);
+        if (end == std::string_view::npos) {
+            return fail("Unterminated attribute value");
+        }
+        if (!decode(text.substr(pos, end - pos), currentValue)) {
+            return XmlEvent::Error;
+        }
+        pos = end + 1;
+        return XmlEvent::Attribute;
+    }
 
-            std::string tag = data.substr(startTag + 1, endTag - startTag - 1);
-            size_t endStartTag = data.find("</" + tag + ">", endTag);
+    // Раскодирует сущности (&lt; &#65; ...); без них возвращает view во входные данные.
+    bool decode(std::string_view raw, std::string_view& decoded) {
+        size_t amp = raw.find('&');
+        if (amp == std::string_view::npos) {
+            decoded = raw;
+            return true;
+        }
+
+        scratch.assign(raw.data(), amp);
+        while (amp < raw.size()) {
+            size_t semicolon = raw.find(';', amp);
+            if (semicolon == std::string_view::npos) {
+                fail("Unterminated entity");
+                return false;
+            }
+            std::string_view entity = raw.substr(amp + 1, semicolon - amp - 1);
+            if (entity == "lt") scratch.push_back('<');
+            else if (entity == "gt") scratch.push_back('>');
+            else if (entity == "amp") scratch.push_back('&');
+            else if (entity == "quot") scratch.push_back('"');
+            else if (entity == "apos") scratch.push_back('\'');
+            else if (entity.size() > 1 && entity[0] == '#') {
+                const bool hex = entity[1] == 'x';
+                const char* first = entity.data() + (hex ? 2 : 1);
+                const char* last = entity.data() + entity.size();
+                unsigned long codePoint = 0;
+                auto parsed = std::from_chars(first, last, codePoint, hex ? 16 : 10);
+                // Допустимы только скалярные значения Unicode: без NUL и суррогатов, не выше U+10FFFF
+                if (parsed.ec != std::errc() || parsed.ptr != last || first == last ||
+                    codePoint == 0 || (codePoint >= 0xD800 && codePoint <= 0xDFFF) || codePoint > 0x10FFFF) {
+                    fail("Invalid character reference");
+                    return false;
+                }
+                appendUtf8(codePoint);
+            }
+            else {
+                fail("Unknown entity");
+                return false;
+            }
 
-            if (endStartTag == std::string::npos) {
-                throw std::runtime_error("Missing closing tag for: " + tag);
+            size_t nextAmp = raw.find('&', semicolon + 1);
+            if (nextAmp == std::string_view::npos) {
+                nextAmp = raw.size();
             }
+            scratch.append(raw.data() + semicolon + 1, nextAmp - semicolon - 1);
+            amp = nextAmp;
+        }
+        decoded = scratch;
+        return true;
+    }
+
+    void appendUtf8(unsigned long codePoint) {
+        if (codePoint < 0x80) {
+            scratch.push_back(static_cast<char>(codePoint));
+        }
+        else if (codePoint < 0x800) {
+            scratch.push_back(static_cast<char>(0xC0 | (codePoint >> 6)));
+            scratch.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+        }
+        else if (codePoint < 0x10000) {
+            scratch.push_back(static_cast<char>(0xE0 | (codePoint >> 12)));
+            scratch.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+            scratch.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+        }
+        else {
+            scratch.push_back(static_cast<char>(0xF0 | (codePoint >> 18)));
+            scratch.push_back(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F)));
+            scratch.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+            scratch.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+        }
+    }
+};
+
+class XMLDataProcessor : public DataProcessor {
+private:
+    XmlPullParser parser;
+    std::string attributeKey;
+
+protected:
+    ProcessStatus validateData(std::string_view data, std::string& message) const override {
+        if (DataProcessor::validateData(data, message) != ProcessStatus::Ok) {
+            return ProcessStatus::InvalidArgument;
+        }
+        if (data.find('<') == std::string_view::npos ||
+            data.find('>') == std::string_view::npos) {
+            return reject(message, ProcessStatus::InvalidArgument, "Invalid XML format");
+        }
+        return ProcessStatus::Ok;
+    }
 
-            std::string value = data.substr(endTag + 1, endStartTag - endTag - 1);
-            result[tag] = value;
+public:
+    // Ключи — пути элементов (user/name), атрибуты — user/@id
+    std::unique_ptr<DataProcessor> clone() const override {
+        return std::make_unique<XMLDataProcessor>();
+    }
 
-            pos = endStartTag + tag.length() + 3;
+    ProcessStatus tryProcessData(std::string_view data, ParseContext& context, std::string& message) override {
+        if (validateData(data, message) != ProcessStatus::Ok) {
+            return ProcessStatus::InvalidArgument;
         }
 
-        if (result.empty()) {
-            throw std::runtime_error("No valid XML tags found");
+        context.reset();
+        parser.reset(data);
+        size_t elements = 0;
+        for (XmlEvent event = parser.next(); event != XmlEvent::EndDocument; event = parser.next()) {
+            switch (event) {
+            case XmlEvent::StartElement:
+                ++elements;
+                break;
+            case XmlEvent::Attribute:
+                attributeKey.assign(parser.elementPath());
+                attributeKey.append("/@");
+                attributeKey.append(parser.name());
+                context.set(attributeKey, parser.value());
+                break;
+            case XmlEvent::Text:
+                context.set(parser.elementPath(), parser.value());
+                break;
+            case XmlEvent::Error:
+                return reject(message, ProcessStatus::ParseError, parser.error());
+            default:
+                break;
+            }
         }
 
-        return result;
+        if (elements == 0) {
+            return reject(message, ProcessStatus::ParseError, "No valid XML tags found");
+        }
+        return ProcessStatus::Ok;
     }
 
     std::string getProcessorType() const override {
@@ -133,57 +1022,362 @@ public:
     }
 };
 
-class JSONDataProcessor : public DataProcessor {
-protected:
-    void validateData(const std::string& data) const override {
-        DataProcessor::validateData(data);
-        if (data.find('{') == std::string::npos ||
-            data.find('}') == std::string::npos ||
-            data.find(':') == std::string::npos) {
-            throw std::invalid_argument("Invalid JSON format");
+// Потоковый (SAX) токенизатор JSON: за один проход вызывает onValue(path, value) для
+// каждого скалярного значения, вложенные объекты и массивы разворачиваются в пути
+// вида "user.address.city" и "tags.0". DOM не строится; буферы пути и строк
+// переиспользуются между документами. Ошибки не бросаются: parse() возвращает false,
+// описание доступно через error().
+class JsonTokenizer {
+public:
+    static constexpr size_t kMaxDepth = 256;
+
+    template <typename OnValue>
+    bool parse(std::string_view input, OnValue&& onValue) {
+        text = input;
+        pos = 0;
+        path.clear();
+        errorMessage = nullptr;
+
+        skipWhitespace();
+        if (pos >= text.size() || (text[pos] != '{' && text[pos] != '[')) {
+            return fail("Malformed structure");
+        }
+        if (!parseValue(onValue, 0)) {
+            return false;
         }
+
+        skipWhitespace();
+        if (pos != text.size()) {
+            return fail("Unexpected trailing characters");
+        }
+        return true;
     }
 
-public:
-    std::map<std::string, std::string> processData(const std::string& data) override {
-        validateData(data);
+    std::string error() const {
+        return std::string(errorMessage ? errorMessage : "No error") + " in JSON at offset " + std::to_string(errorOffset);
+    }
 
-        std::map<std::string, std::string> result;
-        size_t start = data.find('{');
-        size_t end = data.find('}', start);
+private:
+    std::string_view text;
+    size_t pos = 0;
+    std::string path;
+    std::string scratch;
+    const char* errorMessage = nullptr;
+    size_t errorOffset = 0;
 
-        if (start == std::string::npos || end == std::string::npos) {
-            throw std::runtime_error("Malformed JSON structure");
+    bool fail(const char* message) {
+        errorMessage = message;
+        errorOffset = pos;
+        return false;
+    }
+
+    void skipWhitespace() {
+        while (pos < text.size() && (text[pos] == ' ' || text[pos] == '\t' || text[pos] == '\n' || text[pos] == '\r')) {
+            ++pos;
         }
+    }
 
-        std::string content = data.substr(start + 1, end - start - 1);
-        size_t colonPos = content.find(':');
+    bool expect(char c) {
+        skipWhitespace();
+        if (pos >= text.size() || text[pos] != c) {
+            return fail(c == ':' ? "Missing key-value separator" : "Unexpected character");
+        }
+        ++pos;
+        return true;
+    }
 
-        if (colonPos == std::string::npos) {
-            throw std::runtime_error("Missing key-value separator in JSON");
+    static void appendUtf8(std::string& out, uint32_t codePoint) {
+        if (codePoint < 0x80) {
+            out.push_back(static_cast<char>(codePoint));
+        }
+        else if (codePoint < 0x800) {
+            out.push_back(static_cast<char>(0xC0 | (codePoint >> 6)));
+            out.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
         }
+        else if (codePoint < 0x10000) {
+            out.push_back(static_cast<char>(0xE0 | (codePoint >> 12)));
+            out.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+        }
+        else {
+            out.push_back(static_cast<char>(0xF0 | (codePoint >> 18)));
+            out.push_back(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+        }
+    }
 
-        std::string key = content.substr(0, colonPos);
-        std::string value = content.substr(colonPos + 1);
+    bool parseHex4(uint32_t& value) {
+        if (pos + 4 > text.size()) {
+            return fail("Truncated \\u escape");
+        }
+        value = 0;
+        for (int i = 0; i < 4; ++i) {
+            char c = text[pos++];
+            value <<= 4;
+            if (c >= '0' && c <= '9') value |= c - '0';
+            else if (c >= 'a' && c <= 'f') value |= c - 'a' + 10;
+            else if (c >= 'A' && c <= 'F') value |= c - 'A' + 10;
+            else return fail("Invalid \\u escape");
+        }
+        return true;
+    }
 
-        // Удаление лишних пробелов и кавычек
-        key.erase(std::remove_if(key.begin(), key.end(), ::isspace), key.end());
-        value.erase(std::remove_if(value.begin(), value.end(), ::isspace), value.end());
+    // Строка без escape-последовательностей возвращается как view во входные данные,
+    // иначе раскодируется в out и возвращается view на дописанную часть.
+    bool parseString(std::string& out, std::string_view& result) {
+        ++pos;
+        const size_t start = pos;
+        while (pos < text.size() && text[pos] != '"' && text[pos] != '\\') {
+            ++pos;
+        }
+        if (pos >= text.size()) {
+            return fail("Unterminated string");
+        }
+        if (text[pos] == '"') {
+            result = text.substr(start, pos++ - start);
+            return true;
+        }
 
-        if (key.front() == '"' && key.back() == '"') {
-            key = key.substr(1, key.length() - 2);
+        const size_t outStart = out.size();
+        out.append(text.data() + start, pos - start);
+        while (true) {
+            if (pos >= text.size()) {
+                return fail("Unterminated string");
+            }
+            char c = text[pos++];
+            if (c == '"') {
+                break;
+            }
+            if (c != '\\') {
+                out.push_back(c);
+                continue;
+            }
+            if (pos >= text.size()) {
+                return fail("Unterminated string");
+            }
+            switch (text[pos++]) {
+            case '"': out.push_back('"'); break;
+            case '\\': out.push_back('\\'); break;
+            case '/': out.push_back('/'); break;
+            case 'b': out.push_back('\b'); break;
+            case 'f': out.push_back('\f'); break;
+            case 'n': out.push_back('\n'); break;
+            case 'r': out.push_back('\r'); break;
+            case 't': out.push_back('\t'); break;
+            case 'u': {
+                uint32_t codePoint;
+                if (!parseHex4(codePoint)) {
+                    return false;
+                }
+                if (codePoint >= 0xDC00 && codePoint <= 0xDFFF) {
+                    return fail("Unpaired surrogate");
+                }
+                if (codePoint >= 0xD800 && codePoint <= 0xDBFF) {
+                    if (pos + 1 >= text.size() || text[pos] != '\\' || text[pos + 1] != 'u') {
+                        return fail("Unpaired surrogate");
+                    }
+                    pos += 2;
+                    uint32_t low;
+                    if (!parseHex4(low)) {
+                        return false;
+                    }
+                    if (low < 0xDC00 || low > 0xDFFF) {
+                        return fail("Invalid surrogate pair");
+                    }
+                    codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+                }
+                appendUtf8(out, codePoint);
+                break;
+            }
+            default:
+                return fail("Invalid escape sequence");
+            }
         }
+        result = std::string_view(out).substr(outStart);
+        return true;
+    }
 
-        if (value.front() == '"' && value.back() == '"') {
-            value = value.substr(1, value.length() - 2);
+    size_t skipDigits() {
+        const size_t start = pos;
+        while (pos < text.size() && text[pos] >= '0' && text[pos] <= '9') {
+            ++pos;
         }
+        return pos - start;
+    }
 
-        if (key.empty() || value.empty()) {
-            throw std::runtime_error("Empty key or value in JSON");
+    // Ключевые слова true/false/null сравниваются целиком, числа разбираются по
+    // грамматике JSON: -?(0|[1-9]\d*)(\.\d+)?([eE][+-]?\d+)?
+    bool parseLiteral(std::string_view& literal) {
+        const size_t start = pos;
+        for (std::string_view keyword : { std::string_view("true"), std::string_view("false"), std::string_view("null") }) {
+            if (text.compare(pos, keyword.size(), keyword) == 0) {
+                pos += keyword.size();
+                literal = text.substr(start, keyword.size());
+                return true;
+            }
         }
 
-        result[key] = value;
-        return result;
+        if (pos < text.size() && text[pos] == '-') {
+            ++pos;
+        }
+        if (pos >= text.size() || text[pos] < '0' || text[pos] > '9') {
+            return fail(pos == start ? "Unexpected character" : "Invalid number");
+        }
+        if (text[pos] == '0') {
+            ++pos;
+        }
+        else {
+            skipDigits();
+        }
+        if (pos < text.size() && text[pos] == '.') {
+            ++pos;
+            if (skipDigits() == 0) {
+                return fail("Invalid number");
+            }
+        }
+        if (pos < text.size() && (text[pos] == 'e' || text[pos] == 'E')) {
+            ++pos;
+            if (pos < text.size() && (text[pos] == '+' || text[pos] == '-')) {
+                ++pos;
+            }
+            if (skipDigits() == 0) {
+                return fail("Invalid number");
+            }
+        }
+        literal = text.substr(start, pos - start);
+        return true;
+    }
+
+    template <typename OnValue>
+    bool parseValue(OnValue& onValue, size_t depth) {
+        skipWhitespace();
+        if (pos >= text.size()) {
+            return fail("Unexpected end");
+        }
+
+        const char c = text[pos];
+        if (c == '{' || c == '[') {
+            if (depth >= kMaxDepth) {
+                return fail("Nesting too deep");
+            }
+            ++pos;
+            const bool isArray = c == '[';
+            const char close = isArray ? ']' : '}';
+            const size_t pathLength = path.size();
+            size_t index = 0;
+
+            skipWhitespace();
+            if (pos < text.size() && text[pos] == close) {
+                ++pos;
+                return true;
+            }
+
+            while (true) {
+                if (pathLength > 0) {
+                    path.push_back('.');
+                }
+                if (isArray) {
+                    path += std::to_string(index++);
+                }
+                else {
+                    skipWhitespace();
+                    if (pos >= text.size() || text[pos] != '"') {
+                        return fail("Expected string key");
+                    }
+                    const size_t keyStart = path.size();
+                    std::string_view key;
+                    if (!parseString(path, key)) {
+                        return false;
+                    }
+                    if (path.size() == keyStart) {
+                        path.append(key);
+                    }
+                    if (path.size() == keyStart) {
+                        return fail("Empty key");
+                    }
+                    if (!expect(':')) {
+                        return false;
+                    }
+                }
+
+                if (!parseValue(onValue, depth + 1)) {
+                    return false;
+                }
+                path.resize(pathLength);
+
+                skipWhitespace();
+                if (pos < text.size() && text[pos] == ',') {
+                    ++pos;
+                    continue;
+                }
+                return expect(close);
+            }
+        }
+
+        std::string_view value;
+        if (c == '"') {
+            scratch.clear();
+            if (!parseString(scratch, value)) {
+                return false;
+            }
+        }
+        else if (!parseLiteral(value)) {
+            return false;
+        }
+        onValue(std::string_view(path), value);
+        return true;
+    }
+};
+
+class JSONDataProcessor : public DataProcessor {
+protected:
+    ProcessStatus validateData(std::string_view data, std::string& message) const override {
+        if (DataProcessor::validateData(data, message) != ProcessStatus::Ok) {
+            return ProcessStatus::InvalidArgument;
+        }
+        if (data.find('{') == std::string_view::npos ||
+            data.find('}') == std::string_view::npos ||
+            data.find(':') == std::string_view::npos) {
+            return reject(message, ProcessStatus::InvalidArgument, "Invalid JSON format");
+        }
+        return ProcessStatus::Ok;
+    }
+
+private:
+    JsonTokenizer tokenizer;
+
+public:
+    // Потоковый разбор без построения map: onValue(path, value) для каждого значения.
+    template <typename OnValue>
+    void forEachValue(std::string_view data, OnValue&& onValue) {
+        if (!tokenizer.parse(data, onValue)) {
+            throw std::runtime_error(tokenizer.error());
+        }
+    }
+
+    std::unique_ptr<DataProcessor> clone() const override {
+        return std::make_unique<JSONDataProcessor>();
+    }
+
+    ProcessStatus tryProcessData(std::string_view data, ParseContext& context, std::string& message) override {
+        if (validateData(data, message) != ProcessStatus::Ok) {
+            return ProcessStatus::InvalidArgument;
+        }
+
+        context.reset();
+        bool parsed = tokenizer.parse(data, [&](std::string_view path, std::string_view value) {
+            context.set(path, value);
+        });
+
+        if (!parsed) {
+            return reject(message, ProcessStatus::ParseError, tokenizer.error());
+        }
+
+        if (context.size() == 0) {
+            return reject(message, ProcessStatus::ParseError, "Empty key or value in JSON");
+        }
+        return ProcessStatus::Ok;
     }
 
     std::string getProcessorType() const override {
@@ -206,7 +1400,179 @@ void testDataProcessor(DataProcessor& processor, const std::string& testData) {
     }
 }
 
-int main() {
+#if defined(WITH_BENCHMARKS)
+// Сравнение пропускной способности: istringstream + getline против StructuralScanner
+void benchmarkCsvTokenizer() {
+    std::string corpus;
+    const std::string row = "John Doe,30,john@example.com,Moscow,Engineer,2024-01-15,42.5,active\n";
+    while (corpus.size() < 64 * 1024 * 1024) {
+        corpus += row;
+    }
+
+    auto measure = [&](const char* name, auto&& tokenize) {
+        auto start = std::chrono::steady_clock::now();
+        size_t fields = tokenize();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << name << ": " << fields << " fields, "
+            << corpus.size() / (1024.0 * 1024.0) / elapsed.count() << " MB/s\n";
+    };
+
+    measure("istringstream + getline", [&]() {
+        size_t fields = 0;
+        std::istringstream ss(corpus);
+        std::string line;
+        while (std::getline(ss, line)) {
+            std::istringstream lineStream(line);
+            std::string value;
+            while (std::getline(lineStream, value, ',')) {
+                fields += !value.empty();
+            }
+        }
+        return fields;
+    });
+
+    measure("StructuralScanner", [&]() {
+        size_t fields = 0;
+        StructuralScanner scanner(',');
+        scanner.tokenize(corpus,
+            [&](std::string_view value) { fields += !value.empty(); },
+            []() { return true; });
+        return fields;
+    });
+}
+
+// Корпуса и прогоны режима --bench; общая обвязка — bench/bench_harness.h
+constexpr size_t kDeepXmlLevels = 32;
+
+struct Corpus {
+    std::vector<std::string> records;
+    size_t bytes = 0;
+};
+
+template <typename MakeRecord>
+Corpus makeCorpus(size_t targetBytes, MakeRecord&& makeRecord) {
+    Corpus corpus;
+    while (corpus.bytes < targetBytes) {
+        corpus.records.push_back(makeRecord(corpus.records.size()));
+        corpus.bytes += corpus.records.back().size();
+    }
+    return corpus;
+}
+
+std::string makeCsvHeader(size_t columns) {
+    std::string header;
+    for (size_t i = 0; i < columns; ++i) {
+        header += (i ? ",col" : "col") + std::to_string(i);
+    }
+    return header;
+}
+
+std::string makeCsvRow(size_t columns, size_t n) {
+    std::string row;
+    for (size_t i = 0; i < columns; ++i) {
+        if (i) {
+            row.push_back(',');
+        }
+        switch (i % 4) {
+        case 0: row += std::to_string(n); break;
+        case 1: row += "user" + std::to_string(n); break;
+        case 2: row += "user" + std::to_string(n) + "@example.com"; break;
+        default: row += "42.5"; break;
+        }
+    }
+    return row;
+}
+
+std::string makeFlatJson(size_t n) {
+    const std::string id = std::to_string(n);
+    return R"({"id": )" + id + R"(, "name": "user)" + id + R"(", "age": )" + std::to_string(20 + n % 50) +
+        R"(, "email": "user)" + id + R"(@example.com", "active": true})";
+}
+
+std::string makeNestedJson(size_t n) {
+    const std::string id = std::to_string(n);
+    return R"({"user": {"id": )" + id + R"(, "profile": {"name": "user)" + id +
+        R"(", "address": {"city": "Moscow", "zip": "101000"}}}, "tags": ["admin", "dev"], "score": 42.5})";
+}
+
+std::string makeShallowXml(size_t n) {
+    const std::string id = std::to_string(n);
+    return "<user><id>" + id + "</id><name>user" + id + "</name><age>" + std::to_string(20 + n % 50) +
+        "</age><email>user" + id + "@example.com</email></user>";
+}
+
+std::string makeDeepXml(size_t n) {
+    std::string xml;
+    for (size_t level = 0; level < kDeepXmlLevels; ++level) {
+        xml += "<l" + std::to_string(level) + ">";
+    }
+    xml += "<value>" + std::to_string(n) + "</value>";
+    for (size_t level = kDeepXmlLevels; level-- > 0;) {
+        xml += "</l" + std::to_string(level) + ">";
+    }
+    return xml;
+}
+
+// processData() с построением map, processData() с переиспользуемым контекстом и processBatch()
+void benchmarkProcessor(const std::string& name, DataProcessor& processor, size_t corpusSize, const Corpus& corpus) {
+    runBenchmark(name + " processData(map)", corpusSize, corpus.bytes, corpus.records.size(), [&]() {
+        for (const std::string& record : corpus.records) {
+            processor.processData(record);
+        }
+    });
+
+    ParseContext context;
+    runBenchmark(name + " processData(context)", corpusSize, corpus.bytes, corpus.records.size(), [&]() {
+        for (const std::string& record : corpus.records) {
+            processor.processData(record, context);
+        }
+    });
+
+    const std::vector<std::string_view> views(corpus.records.begin(), corpus.records.end());
+    runBenchmark(name + " processBatch", corpusSize, corpus.bytes, corpus.records.size(), [&]() {
+        processor.processBatch(views);
+    });
+}
+
+void runBenchmarks(size_t limit) {
+    CSVDataProcessor csvProcessor;
+    JSONDataProcessor jsonProcessor;
+    XMLDataProcessor xmlProcessor;
+
+    for (size_t corpusSize : kCorpusSizes) {
+        if (corpusSize > limit) {
+            break;
+        }
+
+        for (size_t columns : { kNarrowColumns, kWideColumns }) {
+            const std::string name = columns == kNarrowColumns ? "CSV narrow" : "CSV wide";
+            const std::string header = makeCsvHeader(columns) + "\n";
+            benchmarkProcessor(name, csvProcessor, corpusSize,
+                makeCorpus(corpusSize, [&](size_t n) { return header + makeCsvRow(columns, n); }));
+
+        }
+
+        benchmarkProcessor("JSON flat", jsonProcessor, corpusSize, makeCorpus(corpusSize, makeFlatJson));
+        benchmarkProcessor("JSON nested", jsonProcessor, corpusSize, makeCorpus(corpusSize, makeNestedJson));
+        benchmarkProcessor("XML shallow", xmlProcessor, corpusSize, makeCorpus(corpusSize, makeShallowXml));
+        benchmarkProcessor("XML deep", xmlProcessor, corpusSize, makeCorpus(corpusSize, makeDeepXml));
+    }
+}
+#endif
+
+
+int main(int argc, char* argv[]) {
+#if defined(WITH_BENCHMARKS)
+    if (argc > 1 && std::string(argv[1]) == "--bench") {
+        runBenchmarks(argc > 2 ? std::stoull(argv[2]) << 20 : kDefaultBenchLimit);
+        benchmarkCsvTokenizer();
+        return 0;
+    }
+#else
+    (void)argc;
+    (void)argv;
+#endif
+
     try {
         CSVDataProcessor csvProcessor;
         XMLDataProcessor xmlProcessor;
@@ -214,11 +1580,44 @@ int main() {
 
         std::string csvData = "name,age,email\nJohn Doe,30,john@example.com";
         std::string xmlData = "<user><name>John Doe</name><age>30</age><email>john@example.com</email></user>";
+        std::string nestedXmlData = "<user id=\"7\"><name>Jane &amp; John</name><address><city>Moscow</city></address><active/></user>";
         std::string jsonData = R"({"name": "John Doe", "age": 30, "email": "john@example.com"})";
+        std::string nestedJsonData = R"({"user": {"name": "Jane \"JD\" Roe", "address": {"city": "Moscow"}}, "tags": ["admin", "dev"], "active": true})";
 
         testDataProcessor(csvProcessor, csvData);
         testDataProcessor(xmlProcessor, xmlData);
+        testDataProcessor(xmlProcessor, nestedXmlData);
         testDataProcessor(jsonProcessor, jsonData);
+        testDataProcessor(jsonProcessor, nestedJsonData);
+
+        // Поток однотипных записей через один контекст
+        ParseContext context;
+        const std::string_view csvRecords[] = {
+            "name,age\nJohn,30",
+            "name,age\nJane,25",
+        };
+        for (std::string_view record : csvRecords) {
+            csvProcessor.processData(record, context);
+            context.forEach([](std::string_view key, std::string_view value) {
+                std::cout << key << " => " << value << "\n";
+            });
+        }
+
+        // Пакет с ошибочной записью: ошибка приходит статусом
+        const std::vector<std::string_view> batch = {
+            "<user><name>John</name></user>",
+            "<user><name>Jane</user>",
+            "<user><name>Max</name></user>",
+        };
+        std::vector<BatchResult> results = xmlProcessor.processBatch(batch);
+        for (size_t i = 0; i < results.size(); ++i) {
+            if (results[i].status == ProcessStatus::Ok) {
+                std::cout << "#" << i << " ok, " << results[i].values.size() << " values\n";
+            }
+            else {
+                std::cout << "#" << i << " error: " << results[i].message << "\n";
+            }
+        }
 
 
 
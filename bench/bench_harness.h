@@ -0,0 +1,190 @@
+// Общая обвязка режима --bench (4/40, 5/43, 6/58, 8/75): подсчёт выделений памяти,
+// пиковый RSS и печать строки отчёта. На сгенерированных корпусах от 1 КБ до заданного
+// предела измеряются МБ/с, записей/с, выделений памяти на запись и пиковый RSS прогона.
+// Подключается только при сборке с -DWITH_BENCHMARKS и ровно в одну единицу трансляции:
+// замена глобальных operator new/delete не может быть inline.
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <string>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <sys/resource.h>
+#endif
+
+// Глобальные operator new/delete подменены, чтобы считать выделения памяти. Обычные формы
+// выделяют через malloc и освобождают через free; выровненные — своей парой функций.
+// Функции не встраиваются: иначе GCC видит malloc() в паре с operator delete
+// или free() в паре с operator new и предупреждает о несоответствии.
+static std::atomic<size_t> allocationCount{ 0 };
+
+#if defined(__GNUC__)
+#define BENCH_NOINLINE __attribute__((noinline))
+#else
+#define BENCH_NOINLINE
+#endif
+
+BENCH_NOINLINE void* operator new(size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* memory = std::malloc(size == 0 ? 1 : size)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+BENCH_NOINLINE void* operator new[](size_t size) {
+    return ::operator new(size);
+}
+
+BENCH_NOINLINE void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+BENCH_NOINLINE void operator delete[](void* memory) noexcept {
+    std::free(memory);
+}
+
+BENCH_NOINLINE void operator delete(void* memory, size_t) noexcept {
+    std::free(memory);
+}
+
+BENCH_NOINLINE void operator delete[](void* memory, size_t) noexcept {
+    std::free(memory);
+}
+
+BENCH_NOINLINE void* operator new(size_t size, std::align_val_t alignment) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    const size_t bytes = size == 0 ? 1 : size;
+#if defined(_WIN32)
+    void* memory = _aligned_malloc(bytes, static_cast<size_t>(alignment));
+#else
+    void* memory = nullptr;
+    if (posix_memalign(&memory, std::max(static_cast<size_t>(alignment), sizeof(void*)), bytes) != 0) {
+        memory = nullptr;
+    }
+#endif
+    if (memory == nullptr) {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+BENCH_NOINLINE void* operator new[](size_t size, std::align_val_t alignment) {
+    return ::operator new(size, alignment);
+}
+
+BENCH_NOINLINE void operator delete(void* memory, std::align_val_t) noexcept {
+#if defined(_WIN32)
+    _aligned_free(memory);
+#else
+    std::free(memory);
+#endif
+}
+
+BENCH_NOINLINE void operator delete[](void* memory, std::align_val_t alignment) noexcept {
+    ::operator delete(memory, alignment);
+}
+
+BENCH_NOINLINE void operator delete(void* memory, size_t, std::align_val_t alignment) noexcept {
+    ::operator delete(memory, alignment);
+}
+
+BENCH_NOINLINE void operator delete[](void* memory, size_t, std::align_val_t alignment) noexcept {
+    ::operator delete(memory, alignment);
+}
+
+// Пик RSS процесса в байтах. На Linux читается VmHWM, который сбрасывает PeakResidentMeter.
+inline size_t peakResidentBytes() {
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters{};
+    return GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)) ? counters.PeakWorkingSetSize : 0;
+#else
+#if defined(__linux__)
+    std::ifstream status("/proc/self/status");
+    for (std::string line; std::getline(status, line);) {
+        if (line.compare(0, 6, "VmHWM:") == 0) {
+            return std::strtoull(line.c_str() + 6, nullptr, 10) * 1024;
+        }
+    }
+#endif
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+#if defined(__APPLE__)
+    return static_cast<size_t>(usage.ru_maxrss);
+#else
+    return static_cast<size_t>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
+
+// Пик RSS за время одного прогона. На Linux пик процесса сбрасывается до текущего RSS
+// записью "5" в /proc/self/clear_refs; где сброса нет, печатается прирост пика за прогон.
+class PeakResidentMeter {
+public:
+    PeakResidentMeter() {
+#if defined(__linux__)
+        std::ofstream clearRefs("/proc/self/clear_refs");
+        reset = static_cast<bool>(clearRefs << "5" << std::flush);
+#endif
+        baseline = reset ? 0 : peakResidentBytes();
+    }
+
+    size_t peakBytes() const {
+        return peakResidentBytes() - baseline;
+    }
+
+private:
+    bool reset = false;
+    size_t baseline = 0;
+};
+
+constexpr size_t kCorpusSizes[] = { 1 << 10, 32 << 10, 1 << 20, 32 << 20, 1 << 30 };
+constexpr size_t kDefaultBenchLimit = 32 << 20;
+constexpr size_t kNarrowColumns = 4;
+constexpr size_t kWideColumns = 64;
+constexpr double kMinBenchSeconds = 0.5;
+constexpr int kBenchNameWidth = 40;
+
+inline std::string formatSize(size_t bytes) {
+    return bytes >= (1 << 30) ? std::to_string(bytes >> 30) + " GB"
+        : bytes >= (1 << 20) ? std::to_string(bytes >> 20) + " MB"
+        : std::to_string(bytes >> 10) + " KB";
+}
+
+// Повторяет run() не меньше kMinBenchSeconds и печатает строку отчёта.
+template <typename Run>
+void runBenchmark(const std::string& name, size_t corpusSize, size_t bytes, size_t records, Run&& run) {
+    const size_t allocationsBefore = allocationCount.load();
+    const PeakResidentMeter peakResident;
+    const auto start = std::chrono::steady_clock::now();
+    std::chrono::duration<double> elapsed{};
+    size_t iterations = 0;
+    do {
+        run();
+        ++iterations;
+        elapsed = std::chrono::steady_clock::now() - start;
+    } while (elapsed.count() < kMinBenchSeconds);
+
+    const double totalRecords = static_cast<double>(records) * iterations;
+    std::cout << std::left << std::setw(kBenchNameWidth) << name << std::right << std::setw(7) << formatSize(corpusSize)
+        << std::fixed << std::setprecision(1)
+        << std::setw(10) << bytes * iterations / (1024.0 * 1024.0) / elapsed.count() << " MB/s"
+        << std::setw(13) << std::setprecision(0) << totalRecords / elapsed.count() << " rec/s"
+        << std::setw(9) << std::setprecision(2) << (allocationCount.load() - allocationsBefore) / totalRecords << " alloc/rec"
+        << std::setw(7) << peakResident.peakBytes() / (1024 * 1024) << " MB peak RSS" << std::endl;
+}
+